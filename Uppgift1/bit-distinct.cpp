@@ -0,0 +1,215 @@
+// The bitset all-different propagator for small domains
+//
+// For variables whose values fit in 64 consecutive integers the domains
+// are kept as bit masks. Propagation removes assigned values from the
+// other variables, assigns hidden singles and prunes naked subsets (Hall
+// sets): whenever k variables together can only take k values, those
+// values are removed from all other variables. Naked subsets are searched
+// exhaustively for up to MAX_SUBSET_VARIABLES unassigned variables, which
+// makes the propagator domain consistent for Sudoku's units of nine.
+
+#include <gecode/int.hh>
+
+#include <cstdint>
+
+using namespace Gecode;
+using namespace Gecode::Int;
+
+class BitDistinct : public Propagator {
+protected:
+    // The variables
+    ViewArray<IntView> x;
+    // The value represented by bit 0 of the masks
+    int offset;
+
+    // Number of unassigned variables for which all subsets are searched
+    static const int MAX_SUBSET_VARIABLES = 12;
+
+    // The domain of v as a bit mask
+    uint64_t mask(IntView v) const {
+        uint64_t m = 0;
+        for (ViewRanges<IntView> r(v); r(); ++r) {
+            for (int i = r.min(); i <= r.max(); i++)
+                m |= uint64_t(1) << (i - offset);
+        }
+        return m;
+    }
+
+    // Remove the values in m from v
+    ExecStatus remove(Space& home, IntView v, uint64_t m, bool& modified) {
+        m &= mask(v);
+        for (; m != 0; m &= m - 1) {
+            GECODE_ME_CHECK(v.nq(home, offset + __builtin_ctzll(m)));
+            modified = true;
+        }
+        return ES_OK;
+    }
+
+public:
+    // Create propagator and initialize
+    BitDistinct(Home home, ViewArray<IntView>& x0, int offset0)
+            : Propagator(home), x(x0), offset(offset0) {
+        x.subscribe(home,*this,PC_INT_DOM);
+    }
+
+    // Post bitset all-different propagator
+    static ExecStatus post(Home home, ViewArray<IntView>& x, int offset) {
+        // Only if there is something to propagate
+        if (x.size() > 1)
+            (void) new (home) BitDistinct(home,x,offset);
+        return ES_OK;
+    }
+
+    // Copy constructor during cloning
+    BitDistinct(Space& home, bool share, BitDistinct& p)
+            : Propagator(home,share,p), offset(p.offset) {
+        x.update(home,share,p.x);
+    }
+    // Create copy during cloning
+    virtual Propagator* copy(Space& home, bool share) {
+        return new (home) BitDistinct(home,share,*this);
+    }
+
+    // Re-schedule function after propagator has been re-enabled
+    virtual void reschedule(Space& home) {
+        x.reschedule(home,*this,PC_INT_DOM);
+    }
+
+    // Return cost (defined as expensive quadratic)
+    virtual PropCost cost(const Space&, const ModEventDelta&) const {
+        return PropCost::quadratic(PropCost::HI,x.size());
+    }
+
+    // Perform propagation
+    virtual ExecStatus propagate(Space& home, const ModEventDelta&) {
+        bool modified = true;
+        while (modified) {
+            modified = false;
+            int n = x.size();
+            Region r(home);
+            uint64_t* m = r.alloc<uint64_t>(n);
+            uint64_t all = 0, assigned = 0;
+            for (int i = 0; i < n; i++) {
+                m[i] = mask(x[i]);
+                all |= m[i];
+                if (x[i].assigned()) {
+                    if (assigned & m[i])
+                        return ES_FAILED;
+                    assigned |= m[i];
+                }
+            }
+            if (__builtin_popcountll(all) < n)
+                return ES_FAILED;
+
+            // Naked singles: assigned values are taken
+            for (int i = 0; i < n; i++) {
+                if (!x[i].assigned())
+                    GECODE_ES_CHECK(remove(home, x[i], assigned, modified));
+            }
+            if (modified)
+                continue;
+
+            // Hidden singles: when there are exactly as many values as
+            // variables, a value in a single domain must be taken there
+            if (__builtin_popcountll(all) == n) {
+                uint64_t once = 0, twice = 0;
+                for (int i = 0; i < n; i++) {
+                    twice |= once & m[i];
+                    once |= m[i];
+                }
+                uint64_t single = once & ~twice & ~assigned;
+                for (int i = 0; i < n && single != 0; i++) {
+                    uint64_t v = m[i] & single;
+                    if (v == 0)
+                        continue;
+                    if (__builtin_popcountll(v) > 1)
+                        return ES_FAILED;
+                    GECODE_ME_CHECK(x[i].eq(home, offset + __builtin_ctzll(v)));
+                    modified = true;
+                }
+                if (modified)
+                    continue;
+            }
+
+            // Naked subsets: k variables whose union has k values
+            int* open = r.alloc<int>(n);
+            int k = 0;
+            for (int i = 0; i < n; i++) {
+                if (!x[i].assigned())
+                    open[k++] = i;
+            }
+            if (k > MAX_SUBSET_VARIABLES) {
+                // Only look at pairs of variables
+                for (int a = 0; a < k; a++) {
+                    for (int b = a + 1; b < k; b++) {
+                        uint64_t u = m[open[a]] | m[open[b]];
+                        if (__builtin_popcountll(u) != 2)
+                            continue;
+                        for (int c = 0; c < k; c++) {
+                            if (c != a && c != b)
+                                GECODE_ES_CHECK(remove(home, x[open[c]], u, modified));
+                        }
+                    }
+                }
+                continue;
+            }
+            uint64_t* unions = r.alloc<uint64_t>(1 << k);
+            unions[0] = 0;
+            for (unsigned int s = 1; s < (1u << k); s++) {
+                // The union of a subset extends the union without its lowest variable
+                int lowest = __builtin_ctz(s);
+                unions[s] = unions[s & (s - 1)] | m[open[lowest]];
+                int size = __builtin_popcount(s);
+                int values = __builtin_popcountll(unions[s]);
+                if (values < size)
+                    return ES_FAILED;
+                if (values > size || size == k)
+                    continue;
+                for (int c = 0; c < k; c++) {
+                    if (!(s & (1u << c)) && (m[open[c]] & unions[s]))
+                        GECODE_ES_CHECK(remove(home, x[open[c]], unions[s], modified));
+                }
+                if (modified)
+                    break;
+            }
+        }
+
+        for (int i = 0; i < x.size(); i++) {
+            if (!x[i].assigned())
+                return ES_FIX;
+        }
+        return home.ES_SUBSUMED(*this);
+    }
+
+    // Dispose propagator and return its size
+    virtual size_t dispose(Space& home) {
+        x.cancel(home,*this,PC_INT_DOM);
+        (void) Propagator::dispose(home);
+        return sizeof(*this);
+    }
+};
+
+/*
+ * Post the constraint that all variables in x take distinct values.
+ *
+ * Uses the bitset propagator when the values fit in 64 consecutive
+ * integers, and Gecode's domain consistent distinct otherwise.
+ */
+void bit_distinct(Home home, const IntVarArgs& x) {
+    // Never post a propagator in a failed space
+    if (home.failed()) return;
+    int min = Limits::max, max = Limits::min;
+    for (int i = 0; i < x.size(); i++) {
+        min = std::min(min, x[i].min());
+        max = std::max(max, x[i].max());
+    }
+    if (x.size() > 64 || static_cast<long long int>(max) - min >= 64) {
+        distinct(home, x, IPL_DOM);
+        return;
+    }
+    // Set up array of views for the variables
+    ViewArray<IntView> vx(home,x);
+    // If posting failed, fail space
+    if (BitDistinct::post(home,vx,min) != ES_OK)
+        home.fail();
+}
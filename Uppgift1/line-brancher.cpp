@@ -0,0 +1,152 @@
+// The most-constrained-line brancher for 0/1 boards
+//
+// The board is an n times n matrix of 0/1 variables where every row and
+// every column holds exactly one 1. The brancher picks the row or column
+// without a 1 that has the fewest cells still able to take the value 1,
+// and branches on which of those cells gets it: one alternative per cell.
+
+#include <gecode/int.hh>
+
+using namespace Gecode;
+using namespace Gecode::Int;
+
+class LineBrancher : public Brancher {
+protected:
+    // The cells, row by row
+    ViewArray<IntView> x;
+    // The number of rows and columns
+    int n;
+
+    // The cells of the chosen line that can still take the value 1
+    class Cells : public Choice {
+    public:
+        // The chosen line, rows first and then columns
+        int line;
+        // The indices of the cells in x
+        int* cells;
+
+        Cells(const Brancher& b, int line0, const int* cells0, unsigned int k)
+                : Choice(b, k), line(line0), cells(heap.alloc<int>(k)) {
+            for (unsigned int i = 0; i < k; i++)
+                cells[i] = cells0[i];
+        }
+        virtual size_t size(void) const {
+            return sizeof(*this) + alternatives() * sizeof(int);
+        }
+        virtual void archive(Archive& e) const {
+            Choice::archive(e);
+            e << line << alternatives();
+            for (unsigned int i = 0; i < alternatives(); i++)
+                e << cells[i];
+        }
+        virtual ~Cells(void) {
+            heap.free<int>(cells, alternatives());
+        }
+    };
+
+    // Index in x of cell i of line
+    int cell(int line, int i) const {
+        return line < n ? line * n + i : i * n + (line - n);
+    }
+
+public:
+    // Create brancher
+    LineBrancher(Home home, ViewArray<IntView>& x0, int n0)
+            : Brancher(home), x(x0), n(n0) {}
+
+    // Post the brancher
+    static void post(Home home, ViewArray<IntView>& x, int n) {
+        (void) new (home) LineBrancher(home, x, n);
+    }
+
+    // Copy constructor during cloning
+    LineBrancher(Space& home, bool share, LineBrancher& b)
+            : Brancher(home, share, b), n(b.n) {
+        x.update(home, share, b.x);
+    }
+    // Create copy during cloning
+    virtual Actor* copy(Space& home, bool share) {
+        return new (home) LineBrancher(home, share, *this);
+    }
+
+    // Whether there is a cell left to branch on
+    virtual bool status(const Space&) const {
+        for (int i = 0; i < x.size(); i++) {
+            if (!x[i].assigned())
+                return true;
+        }
+        return false;
+    }
+
+    // The line without a 1 with the fewest candidate cells
+    virtual Choice* choice(Space& home) {
+        Region r(home);
+        int* candidates = r.alloc<int>(n);
+        int* best = r.alloc<int>(n);
+        int bestLine = -1, bestCount = n + 1;
+        for (int line = 0; line < 2 * n; line++) {
+            int count = 0;
+            bool placed = false;
+            for (int i = 0; i < n && !placed; i++) {
+                IntView v = x[cell(line, i)];
+                if (v.assigned() && v.val() == 1)
+                    placed = true;
+                else if (v.max() == 1)
+                    candidates[count++] = cell(line, i);
+            }
+            if (placed || count == 0 || count >= bestCount)
+                continue;
+            bestLine = line;
+            bestCount = count;
+            for (int i = 0; i < count; i++)
+                best[i] = candidates[i];
+            if (count == 1)
+                break;
+        }
+        // status() guarantees an unassigned cell, so at propagation fixpoint
+        // some line without a 1 has candidates
+        return new Cells(*this, bestLine, best, bestCount);
+    }
+    virtual Choice* choice(const Space& home, Archive& e) {
+        int line;
+        unsigned int k;
+        e >> line >> k;
+        Region r(home);
+        int* cells = r.alloc<int>(k);
+        for (unsigned int i = 0; i < k; i++)
+            e >> cells[i];
+        return new Cells(*this, line, cells, k);
+    }
+
+    // Place the 1 of the line on cell a
+    virtual ExecStatus commit(Space& home, const Choice& c, unsigned int a) {
+        const Cells& ch = static_cast<const Cells&>(c);
+        return me_failed(x[ch.cells[a]].eq(home, 1)) ? ES_FAILED : ES_OK;
+    }
+
+    // Print explanation
+    virtual void print(const Space&, const Choice& c, unsigned int a, std::ostream& o) const {
+        const Cells& ch = static_cast<const Cells&>(c);
+        int i = ch.cells[a];
+        o << (ch.line < n ? "row " : "column ") << ch.line % n
+          << ": cell (" << i % n << ", " << i / n << ") = 1";
+    }
+
+    // Dispose brancher and return its size
+    virtual size_t dispose(Space& home) {
+        (void) Brancher::dispose(home);
+        return sizeof(*this);
+    }
+};
+
+/*
+ * Branch on the n times n board x, row by row, by placing the 1 of the
+ * row or column with the fewest remaining cells.
+ */
+void line_branch(Home home, const IntVarArgs& x, int n) {
+    if (x.size() != n * n)
+        throw ArgumentSizeMismatch("line_branch");
+    if (home.failed()) return;
+    ViewArray<IntView> vx(home, x);
+    LineBrancher::post(home, vx, n);
+}
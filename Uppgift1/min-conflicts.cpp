@@ -0,0 +1,187 @@
+// Min-conflicts local search for n-queens
+//
+// The board is a permutation: row r holds its queen in column col[r], so
+// rows and columns never conflict and only the diagonals need counters.
+// The search starts from a greedy permutation. Each step picks a random
+// queen under attack and swaps its column with the row that leaves the
+// fewest collisions, ties broken at random, also when that only keeps the
+// count (a sideways move). Memory is three int arrays of about n and 2n
+// entries, every step tries all n - 1 partners in O(1) each.
+
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+class MinConflicts {
+protected:
+    // Steps without a better placement before starting over
+    static const unsigned long int MAX_STALLED_STEPS = 1 << 12;
+
+    int n;
+    // The column of the queen in each row
+    std::vector<int> col;
+    // Number of queens on each diagonal, indexed by r - c + n - 1 and r + c
+    std::vector<int> down, up;
+    // Number of pairs of queens on a common diagonal, counted per extra queen
+    long long int collisions;
+    std::mt19937 random;
+    // The partners leaving the fewest collisions in the current step
+    std::vector<int> best;
+
+    int& downOf(int r, int c) { return down[r - c + n - 1]; }
+    int& upOf(int r, int c) { return up[r + c]; }
+
+    void place(int r, int c) {
+        col[r] = c;
+        if (downOf(r, c)++ > 0)
+            collisions++;
+        if (upOf(r, c)++ > 0)
+            collisions++;
+    }
+
+    void remove(int r) {
+        int c = col[r];
+        if (--downOf(r, c) > 0)
+            collisions--;
+        if (--upOf(r, c) > 0)
+            collisions--;
+    }
+
+    bool attacked(int r) {
+        return downOf(r, col[r]) > 1 || upOf(r, col[r]) > 1;
+    }
+
+    void swap(int i, int j) {
+        int ci = col[i], cj = col[j];
+        remove(i);
+        remove(j);
+        place(i, cj);
+        place(j, ci);
+    }
+
+    // Random permutation where each row takes, when it can find one within
+    // a few tries, a column whose diagonals are free of the rows above it
+    void initialize() {
+        std::fill(down.begin(), down.end(), 0);
+        std::fill(up.begin(), up.end(), 0);
+        collisions = 0;
+        for (int r = 0; r < n; r++)
+            col[r] = r;
+        std::shuffle(col.begin(), col.end(), random);
+        const int tries = 8;
+        for (int r = 0; r < n; r++) {
+            for (int t = 0; t < tries && r + 1 < n; t++) {
+                std::uniform_int_distribution<int> other(r, n - 1);
+                int j = other(random);
+                if (downOf(r, col[j]) == 0 && upOf(r, col[j]) == 0) {
+                    std::swap(col[r], col[j]);
+                    break;
+                }
+            }
+            place(r, col[r]);
+        }
+    }
+
+public:
+    // Statistics of the last solve
+    unsigned long int steps, swaps, restarts;
+    double ms;
+
+    MinConflicts(int n0, unsigned int seed)
+            : n(n0), col(n0), down(2 * n0 - 1), up(2 * n0 - 1), collisions(0),
+              random(seed), steps(0), swaps(0), restarts(0), ms(0) {}
+
+    // Search for a placement, false if stopped by the step limit (0 for none)
+    bool solve(unsigned long int maxSteps) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        steps = swaps = restarts = 0;
+        bool solved = n != 2 && n != 3;
+        if (solved) {
+            initialize();
+            // The rows that may be under attack, only rescanned when empty
+            std::vector<int> attackedRows;
+            unsigned long int stalled = 0;
+            while (collisions > 0) {
+                if (maxSteps > 0 && steps >= maxSteps) {
+                    solved = false;
+                    break;
+                }
+                if (stalled > MAX_STALLED_STEPS) {
+                    initialize();
+                    attackedRows.clear();
+                    restarts++;
+                    stalled = 0;
+                    continue;
+                }
+                if (attackedRows.empty()) {
+                    for (int r = 0; r < n; r++) {
+                        if (attacked(r))
+                            attackedRows.push_back(r);
+                    }
+                }
+                std::uniform_int_distribution<std::size_t> pick(0, attackedRows.size() - 1);
+                std::swap(attackedRows[pick(random)], attackedRows.back());
+                int i = attackedRows.back();
+                attackedRows.pop_back();
+                if (!attacked(i))
+                    continue;
+                steps++;
+                stalled++;
+                long long int old = collisions, fewest = -1;
+                best.clear();
+                for (int j = 0; j < n; j++) {
+                    if (j == i)
+                        continue;
+                    swap(i, j);
+                    if (fewest < 0 || collisions < fewest) {
+                        fewest = collisions;
+                        best.clear();
+                    }
+                    if (collisions == fewest)
+                        best.push_back(j);
+                    swap(i, j);
+                }
+                if (fewest > old)
+                    continue;
+                std::uniform_int_distribution<std::size_t> tie(0, best.size() - 1);
+                int j = best[tie(random)];
+                swap(i, j);
+                swaps++;
+                if (collisions < old)
+                    stalled = 0;
+                if (attacked(j))
+                    attackedRows.push_back(j);
+                if (attacked(i))
+                    attackedRows.push_back(i);
+            }
+        }
+        ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return solved;
+    }
+
+    // Whether the permutation is a solution, checked from scratch
+    bool valid() const {
+        std::vector<bool> d(2 * n - 1, false), u(2 * n - 1, false), c(n, false);
+        for (int r = 0; r < n; r++) {
+            if (c[col[r]] || d[r - col[r] + n - 1] || u[r + col[r]])
+                return false;
+            c[col[r]] = d[r - col[r] + n - 1] = u[r + col[r]] = true;
+        }
+        return true;
+    }
+
+    // Print the board like Queens::print
+    void print(std::ostream& os) const {
+        std::string line;
+        for (int r = 0; r < n; r++) {
+            line.assign(2 * n, ' ');
+            for (int c = 0; c < n; c++)
+                line[2 * c] = c == col[r] ? '1' : '0';
+            os << line << '\n';
+        }
+        os.flush();
+    }
+};
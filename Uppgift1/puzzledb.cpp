@@ -0,0 +1,66 @@
+// Convert Sudoku collections between text and the binary puzzle database
+//
+//   puzzledb <text file> <database>   convert a text collection
+//   puzzledb -print <database> <id>   print one puzzle of a database
+//
+// A text collection has one puzzle per line: 81 cells row by row, digits
+// with 0 or . for an empty cell. Other characters are ignored, so the
+// cells may be separated by spaces. Empty lines and lines starting with #
+// are skipped.
+
+#include "puzzledb.hh"
+
+#include <cstdlib>
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+    try {
+        if (argc == 4 && std::string(argv[1]) == "-print") {
+            PuzzleDB db(argv[2]);
+            int cells[PuzzleDB::CELLS];
+            db.get(std::strtoull(argv[3], NULL, 10), cells);
+            for (int i = 0; i < PuzzleDB::CELLS; i++)
+                std::cout << cells[i] << ((i + 1) % 9 == 0 ? "\n" : " ");
+            return 0;
+        }
+        if (argc != 3) {
+            std::cerr << "usage: " << argv[0] << " <text file> <database>" << std::endl
+                      << "       " << argv[0] << " -print <database> <id>" << std::endl;
+            return 2;
+        }
+
+        std::ifstream in(argv[1]);
+        if (!in) {
+            std::cerr << "cannot read " << argv[1] << std::endl;
+            return 1;
+        }
+        std::vector<int> puzzles;
+        std::string line;
+        for (int number = 1; std::getline(in, line); number++) {
+            if (line.empty() || line[0] == '#')
+                continue;
+            int n = 0;
+            for (size_t i = 0; i < line.size(); i++) {
+                char c = line[i];
+                if (c >= '0' && c <= '9')
+                    puzzles.push_back(c - '0');
+                else if (c == '.')
+                    puzzles.push_back(0);
+                else
+                    continue;
+                n++;
+            }
+            if (n != PuzzleDB::CELLS) {
+                std::cerr << argv[1] << ":" << number << ": expected " << PuzzleDB::CELLS
+                          << " cells, found " << n << std::endl;
+                return 1;
+            }
+        }
+        PuzzleDB::write(argv[2], puzzles);
+        std::cout << puzzles.size() / PuzzleDB::CELLS << " puzzles written to " << argv[2] << std::endl;
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
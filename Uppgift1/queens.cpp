@@ -39,6 +39,21 @@
 #include <gecode/int.hh>
 #include <gecode/minimodel.hh>
 
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+#include "driver-options.hh"
+#include "accounting.hh"
+#include "recomputation.hh"
+#include "clone-stats.hh"
+#include "flatzinc.hh"
+#include "telemetry.hh"
+#include "trace.hh"
+
+#include "line-brancher.cpp"
+#include "min-conflicts.cpp"
+
 #if defined(GECODE_HAS_QT) && defined(GECODE_HAS_GIST)
 #include <QtGui>
 #if QT_VERSION >= 0x050000
@@ -61,12 +76,24 @@ class Queens : public Script {
 public:
   int size;
   IntVarArray matrixData;
+  /// Counts this space among the spaces alive
+  Accounting::Live live;
   /// Propagation to use for model
   enum {
     PROP_BINARY,  ///< Use only binary disequality constraints
     PROP_MIXED,   ///< Use single distinct and binary disequality constraints
     PROP_DISTINCT ///< Use three distinct constraints
   };
+  /// Model variants
+  enum {
+    MODEL_MATRIX, ///< Use the 0/1 board with constraint propagation
+    MODEL_LOCAL   ///< Use min-conflicts local search on a permutation
+  };
+  /// Branching to use for model
+  enum {
+    BRANCH_CELLS, ///< Branch on the cells in input order
+    BRANCH_LINES  ///< Place the queen of the most constrained row or column
+  };
 
   Queens(const SizeOptions& opt)
     : Script(opt),
@@ -114,23 +141,91 @@ public:
       rel(*this, sumOfUpDiagonal <= 1);
     }
 
-    branch(*this, matrixData, INT_VAR_SIZE_MAX(), INT_VALUES_MAX());
+    switch (opt.branching()) {
+    case BRANCH_CELLS:
+      branch(*this, matrixData, INT_VAR_SIZE_MAX(), INT_VALUES_MAX());
+      break;
+    case BRANCH_LINES:
+      line_branch(*this, matrixData, size);
+      break;
+    }
   }
 
   /// Constructor for cloning \a sS
-  Queens(bool share, Queens& s, int size) : Script(share,s), size(size) {
+  Queens(bool share, Queens& s) : Script(share,s), size(s.size) {
     matrixData.update(*this, share, s.matrixData);
   }
 
+  /// Count the variables of the space
+  void account(Accounting& a) const {
+    a.vars("IntVar", matrixData.size());
+  }
+
   /// Perform copying during cloning
   virtual Space*
   copy(bool share) {
-    return new Queens(share, *this, size);
+    CloneStats::record(*this);
+    return new Queens(share, *this);
+  }
+
+  /// Write the model for size \a opt.size() as FlatZinc to \a os
+  static void
+  flatzinc(std::ostream& os, const SizeOptions& opt) {
+    const int size = opt.size();
+    FlatZinc fz;
+    std::vector<std::string> cells;
+    for (int i = 0; i < size*size; i++) {
+      std::ostringstream name;
+      name << "cell_" << i / size << "_" << i % size;
+      cells.push_back(fz.var(name.str(), 0, 1));
+    }
+    fz.output("board", cells);
+
+    for (int line = 0; line < size; line++) {
+      std::vector<std::string> row, col;
+      for (int i = 0; i < size; i++) {
+        row.push_back(cells[line * size + i]);
+        col.push_back(cells[i * size + line]);
+      }
+      std::vector<int> ones(size, 1);
+      fz.constraint("int_lin_eq(" + FlatZinc::list(ones) + ", " + FlatZinc::list(row) + ", 1)");
+      fz.constraint("int_lin_eq(" + FlatZinc::list(ones) + ", " + FlatZinc::list(col) + ", 1)");
+    }
+
+    for (int diagonalIndex = -size+1; diagonalIndex < size; diagonalIndex++) {
+      int colIdx = std::max(diagonalIndex, 0);
+      int rowIdx = std::max(-diagonalIndex, 0);
+      int steps = size - 1 - std::abs(diagonalIndex);
+      std::vector<std::string> down, up;
+      for (int idx = 0; idx <= steps; idx++) {
+        down.push_back(cells[(rowIdx + idx) * size + colIdx + idx]);
+        up.push_back(cells[(size - 1 - (rowIdx + idx)) * size + colIdx + idx]);
+      }
+      std::vector<int> ones(steps + 1, 1);
+      fz.constraint("int_lin_le(" + FlatZinc::list(ones) + ", " + FlatZinc::list(down) + ", 1)");
+      fz.constraint("int_lin_le(" + FlatZinc::list(ones) + ", " + FlatZinc::list(up) + ", 1)");
+    }
+
+    // FlatZinc has no line brancher, both branchings use the cell order
+    fz.finish(os, FlatZinc::search(cells, "anti_first_fail", "indomain_max"));
   }
 
   /// Print solution
   virtual void
   print(std::ostream& os) const {
+    SolutionWriter& writer = SolutionWriter::global();
+    if (writer.active()) {
+      // The column of the queen in each row
+      std::vector<int> columns(size);
+      for (int rowIdx = 0; rowIdx < size; rowIdx++) {
+        for (int colIdx = 0; colIdx < size; colIdx++) {
+          if (matrixData[colIdx + rowIdx * size].val() == 1)
+            columns[rowIdx] = colIdx;
+        }
+      }
+      writer.write(columns);
+      return;
+    }
     for (int rowIdx = 0; rowIdx < size; rowIdx++) {
       for (int colIdx = 0; colIdx < size; colIdx++) {
         IntVar cellValue = matrixData[colIdx + rowIdx * size];
@@ -207,12 +302,100 @@ public:
 
 #endif /* GECODE_HAS_GIST */
 
+/// Options for the local search model
+class QueensOptions : public DriverOptions {
+protected:
+  /// Print only a summary instead of the board
+  Driver::BoolOption _summary;
+  /// Seed for the local search
+  Driver::UnsignedIntOption _lsSeed;
+  /// Maximal number of local search steps (0 for none)
+  Driver::UnsignedIntOption _lsSteps;
+  /// Only count all solutions
+  Driver::BoolOption _count;
+public:
+  /// Initialize options for example with name \a s
+  QueensOptions(const char* s)
+    : DriverOptions(s),
+      _summary("summary", "print only a summary, not the board", false),
+      _lsSeed("ls-seed", "seed for the local search", 1),
+      _lsSteps("ls-steps", "maximal number of local search steps (0 for none)", 0),
+      _count("count", "only count all solutions, with -threads in parallel", false) {
+    add(_summary);
+    add(_lsSeed);
+    add(_lsSteps);
+    add(_count);
+  }
+  bool summary(void) const { return _summary.value(); }
+  unsigned int lsSeed(void) const { return _lsSeed.value(); }
+  unsigned int lsSteps(void) const { return _lsSteps.value(); }
+  bool count(void) const { return _count.value(); }
+};
+
+/// Count all solutions without printing them
+///
+/// Gecode's parallel DFS runs -threads workers that steal the open
+/// alternative closest to the root from each other. A stolen node is
+/// recomputed from the closest clone above it, so -c-d and -a-d set the
+/// cost of a steal against the cost of cloning. Every solution is
+/// deleted as soon as the engine hands it over.
+void
+countSolutions(const QueensOptions& opt) {
+  Search::Options so;
+  so.threads = opt.threads();
+  so.c_d = opt.c_d();
+  so.a_d = opt.a_d();
+  std::unique_ptr<Search::TimeStop> stop;
+  if (opt.time() > 0) {
+    stop.reset(new Search::TimeStop(opt.time()));
+    so.stop = stop.get();
+  }
+  Support::Timer t;
+  t.start();
+  Queens* root = new Queens(opt);
+  DFS<Queens> e(root, so);
+  delete root;
+  unsigned long int solutions = 0;
+  while (Queens* s = e.next()) {
+    delete s;
+    solutions++;
+  }
+  Search::Statistics stat = e.statistics();
+  std::cout << "Count" << std::endl
+            << "\tsize:         " << opt.size() << std::endl
+            << "\tthreads:      " << so.expand().threads << std::endl
+            << "\tsolutions:    " << solutions << std::endl
+            << "\truntime:      " << t.stop() << " ms" << std::endl
+            << "\tnodes:        " << stat.node << std::endl
+            << "\tfailures:     " << stat.fail << std::endl;
+  if (e.stopped())
+    std::cout << "Search engine stopped..." << std::endl;
+}
+
+/// Find a single placement with min-conflicts local search
+void
+localSearch(const QueensOptions& opt) {
+  MinConflicts search(opt.size(), opt.lsSeed());
+  bool solved = search.solve(opt.lsSteps());
+  if (solved && !opt.summary())
+    search.print(std::cout);
+  std::cout << std::endl
+            << "Local search" << std::endl
+            << "\tsize:         " << opt.size() << std::endl
+            << "\tsolved:       " << (solved && search.valid() ? "yes" : "no") << std::endl
+            << "\tsteps:        " << search.steps << std::endl
+            << "\tswaps:        " << search.swaps << std::endl
+            << "\trestarts:     " << search.restarts << std::endl
+            << "\truntime:      " << search.ms << " ms" << std::endl;
+}
+
+#ifndef SOLVERD
 /** \brief Main-function
  *  \relates Queens
  */
 int
 main(int argc, char* argv[]) {
-  SizeOptions opt("Queens");
+  QueensOptions opt("Queens");
   opt.iterations(500);
   opt.size(9);
   opt.propagation(Queens::PROP_DISTINCT);
@@ -222,6 +405,16 @@ main(int argc, char* argv[]) {
                       "single distinct and binary disequality constraints");
   opt.propagation(Queens::PROP_DISTINCT, "distinct",
                       "three distinct constraints");
+  opt.model(Queens::MODEL_MATRIX);
+  opt.model(Queens::MODEL_MATRIX, "matrix",
+                "0/1 board with constraint propagation");
+  opt.model(Queens::MODEL_LOCAL, "local",
+                "min-conflicts local search for one placement");
+  opt.branching(Queens::BRANCH_CELLS);
+  opt.branching(Queens::BRANCH_CELLS, "cells",
+                    "cells in input order");
+  opt.branching(Queens::BRANCH_LINES, "lines",
+                    "row or column with the fewest legal cells");
 
 #if defined(GECODE_HAS_QT) && defined(GECODE_HAS_GIST)
 
@@ -230,9 +423,35 @@ main(int argc, char* argv[]) {
 #endif
 
   opt.parse(argc,argv);
-  Script::run<Queens,DFS,SizeOptions>(opt);
+  if (opt.flatzinc() != NULL) {
+    std::ofstream fz(opt.flatzinc());
+    Queens::flatzinc(fz, opt);
+    return 0;
+  }
+  if (opt.model() == Queens::MODEL_LOCAL) {
+    localSearch(opt);
+    return 0;
+  }
+  CloneStats::enable(opt.cloneStats());
+  SolutionWriter::global().open(opt.output(), opt.outputFile(), opt.size() - 1);
+  if (opt.calibrate() > 0)
+    calibrate<Queens>(opt);
+  Accounting::start<Queens>(opt);
+  if (opt.count())
+    countSolutions(opt);
+  else if (opt.trace() != NULL)
+    runWithTrace<Queens,QueensOptions>(opt);
+  else if (opt.progress() > 0)
+    runWithProgress<Queens,DFS,QueensOptions>(opt);
+  else
+    Script::run<Queens,DFS,QueensOptions>(opt);
+  SolutionWriter::global().close();
+  Accounting::finish(opt, "Queens");
+  if (opt.cloneStats())
+    CloneStats::print(std::cout);
   return 0;
 }
+#endif
 
 // STATISTICS: example-any
 
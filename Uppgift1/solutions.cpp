@@ -0,0 +1,50 @@
+// Decode binary solutions written with -output binary
+//
+//   solutions <file>   print one solution per line, values separated by spaces
+//
+// See solution-writer.hh for the file layout.
+
+#include "solution-writer.hh"
+
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <file>" << std::endl;
+        return 2;
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    SolutionWriter::Header h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) ||
+        std::memcmp(h.magic, "GSOLUTNS", 8) != 0 || h.bits == 0 || h.bits > 31) {
+        std::cerr << "not a solution file: " << argv[1] << std::endl;
+        return 1;
+    }
+    size_t bytes = (static_cast<size_t>(h.values) * h.bits + 7) / 8;
+    std::vector<unsigned char> record(bytes);
+    std::string line;
+    unsigned long int count = 0;
+    while (in.read(reinterpret_cast<char*>(record.data()), bytes)) {
+        line.clear();
+        size_t bit = 0;
+        for (uint32_t i = 0; i < h.values; i++) {
+            int value = 0;
+            for (uint32_t b = 0; b < h.bits; b++, bit++) {
+                if ((record[bit / 8] >> (bit % 8)) & 1)
+                    value |= 1 << b;
+            }
+            if (i > 0)
+                line += ' ';
+            line += std::to_string(value);
+        }
+        line += '\n';
+        std::cout << line;
+        count++;
+    }
+    if (in.gcount() != 0) {
+        std::cerr << "truncated record after " << count << " solutions" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+// Solver service for Sudoku and Queens requests
+//
+// Keeps the root spaces of the models in memory and answers requests
+// over a Unix domain socket, see solver-service.hh for the protocol:
+//
+//   sudoku <81 cells, digits with 0 or . for empty>
+//   queens <n>
+//   stats
+//
+// Every request clones a root space and searches for the first solution.
+// Cloning changes the space being cloned, so each root is cloned under its
+// own lock, and without sharing so that the clone is independent of all
+// other threads.
+//
+// With -request the program instead sends one request to a running
+// service and prints the reply.
+
+#define SOLVERD
+#include "sudoku.cpp"
+#include "queens.cpp"
+
+#include "solver-service.hh"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+class ServiceOptions : public BaseOptions {
+protected:
+    Driver::StringValueOption _socket;
+    Driver::UnsignedIntOption _workers;
+    Driver::UnsignedIntOption _requestTime;
+    Driver::StringValueOption _request;
+public:
+    ServiceOptions(const char* s)
+            : BaseOptions(s),
+              _socket("socket", "path of the Unix domain socket", "/tmp/solverd.sock"),
+              _workers("workers", "number of requests answered concurrently", 4),
+              _requestTime("request-time", "time limit per request in ms (0 for none)", 1000),
+              _request("request", "send a request to a running service and print the reply", NULL) {
+        add(_socket);
+        add(_workers);
+        add(_requestTime);
+        add(_request);
+    }
+
+    const char* socket() const { return _socket.value(); }
+    unsigned int workers() const { return _workers.value(); }
+    unsigned int requestTime() const { return _requestTime.value(); }
+    const char* request() const { return _request.value(); }
+};
+
+// Largest Queens instance answered, the model has n * n variables
+const int MAX_QUEENS = 256;
+
+class Solvers {
+protected:
+    const ServiceOptions& opt;
+
+    // Sudoku without givens, the givens are posted into each clone
+    Sudoku* sudoku;
+    std::mutex sudokuMutex;
+
+    // Queens roots by size, built on first use
+    std::map<int, Queens*> queens;
+    std::mutex queensMutex;
+
+    // First solution of s printed, the engine takes s over
+    template<class Model>
+    std::string solve(Model* s) {
+        Search::Options so;
+        so.clone = false;
+        std::unique_ptr<Search::TimeStop> stop;
+        if (opt.requestTime() > 0) {
+            stop.reset(new Search::TimeStop(opt.requestTime()));
+            so.stop = stop.get();
+        }
+        DFS<Model> e(s, so);
+        std::unique_ptr<Model> solution(e.next());
+        if (solution.get() == NULL)
+            return e.stopped() ? "error\ntime limit reached\n" : "unsat\n";
+        std::ostringstream os;
+        os << "ok" << std::endl;
+        solution->print(os);
+        return os.str();
+    }
+
+public:
+    Solvers(const ServiceOptions& opt0) : opt(opt0) {
+        SudokuOptions o("Sudoku");
+        o.branching(Sudoku::BRANCH_SIZE_AFC);
+        o.propagation(Sudoku::PROP_BITSET);
+        static const int empty[9][9] = {};
+        sudoku = new Sudoku(o, NULL, empty);
+        (void) sudoku->status();
+    }
+
+    ~Solvers() {
+        delete sudoku;
+        for (std::map<int, Queens*>::iterator i = queens.begin(); i != queens.end(); ++i)
+            delete i->second;
+    }
+
+    std::string solveSudoku(const std::string& cells) {
+        int puzzle[9][9];
+        int n = 0;
+        for (size_t i = 0; i < cells.size() && n < 81; i++) {
+            char c = cells[i];
+            if (c >= '0' && c <= '9')
+                puzzle[n / 9][n % 9] = c - '0';
+            else if (c == '.')
+                puzzle[n / 9][n % 9] = 0;
+            else
+                continue;
+            n++;
+        }
+        if (n != 81)
+            return "error\nexpected 81 cells\n";
+        Sudoku* s;
+        {
+            std::lock_guard<std::mutex> lock(sudokuMutex);
+            s = static_cast<Sudoku*>(sudoku->clone(false));
+        }
+        s->givens(puzzle);
+        return solve(s);
+    }
+
+    std::string solveQueens(const std::string& arguments) {
+        int n = std::atoi(arguments.c_str());
+        if (n < 1 || n > MAX_QUEENS)
+            return "error\nsize must be between 1 and " + std::to_string(MAX_QUEENS) + "\n";
+        Queens* s;
+        {
+            std::lock_guard<std::mutex> lock(queensMutex);
+            std::map<int, Queens*>::iterator root = queens.find(n);
+            if (root == queens.end()) {
+                SizeOptions o("Queens");
+                o.size(n);
+                o.branching(Queens::BRANCH_LINES);
+                root = queens.insert(std::make_pair(n, new Queens(o))).first;
+                (void) root->second->status();
+            }
+            s = static_cast<Queens*>(root->second->clone(false));
+        }
+        return solve(s);
+    }
+};
+
+int main(int argc, char* argv[]) {
+    ServiceOptions opt("solverd");
+    opt.parse(argc, argv);
+
+    if (opt.request() != NULL) {
+        int fd = Frame::connect(opt.socket());
+        std::string reply;
+        if (fd < 0 || !Frame::write(fd, opt.request()) || !Frame::read(fd, reply)) {
+            std::cerr << "no service on " << opt.socket() << std::endl;
+            return 1;
+        }
+        close(fd);
+        std::cout << reply;
+        return 0;
+    }
+
+    Solvers solvers(opt);
+    SolverService service;
+    service.add("sudoku", [&solvers](const std::string& a) { return solvers.solveSudoku(a); });
+    service.add("queens", [&solvers](const std::string& a) { return solvers.solveQueens(a); });
+    try {
+        service.run(opt.socket(), opt.workers());
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
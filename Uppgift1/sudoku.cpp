@@ -1,213 +1,100 @@
 #include <gecode/int.hh>
 #include <gecode/driver.hh>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "driver-options.hh"
+#include "accounting.hh"
+#include "recomputation.hh"
+#include "clone-stats.hh"
+#include "flatzinc.hh"
+#include "puzzledb.hh"
+#include "telemetry.hh"
+#include "trace.hh"
+
+// The bitset all-different propagator
+#include "bit-distinct.cpp"
+
 using namespace Gecode;
 
-namespace {
-    static int examples[][9][9] = {
-            {
-                    {0,0,0, 2,0,5, 0,0,0},
-                    {0,9,0, 0,0,0, 7,3,0},
-                    {0,0,2, 0,0,9, 0,6,0},
-                    {2,0,0, 0,0,0, 4,0,9},
-                    {0,0,0, 0,7,0, 0,0,0},
-                    {6,0,9, 0,0,0, 0,0,1},
-                    {0,8,0, 4,0,0, 1,0,0},
-                    {0,6,3, 0,0,0, 0,8,0},
-                    {0,0,0, 6,0,8, 0,0,0}
-            },
-            {
-                    {3,0,0, 9,0,4, 0,0,1},
-                    {0,0,2, 0,0,0, 4,0,0},
-                    {0,6,1, 0,0,0, 7,9,0},
-                    {6,0,0, 2,4,7, 0,0,5},
-                    {0,0,0, 0,0,0, 0,0,0},
-                    {2,0,0, 8,3,6, 0,0,4},
-                    {0,4,6, 0,0,0, 2,3,0},
-                    {0,0,9, 0,0,0, 6,0,0},
-                    {5,0,0, 3,0,9, 0,0,8}
-            },
-            {
-                    {0,0,0, 0,1,0, 0,0,0},
-                    {3,0,1, 4,0,0, 8,6,0},
-                    {9,0,0, 5,0,0, 2,0,0},
-                    {7,0,0, 1,6,0, 0,0,0},
-                    {0,2,0, 8,0,5, 0,1,0},
-                    {0,0,0, 0,9,7, 0,0,4},
-                    {0,4,8, 0,0,6, 9,0,7},
-                    {0,0,0, 0,8,0, 0,0,0}
-            },
-            {	// Fiendish puzzle April 21, 2005 Times London
-                    {0,0,4, 0,0,3, 0,7,0},
-                    {0,8,0, 0,7,0, 0,0,0},
-                    {0,7,0, 0,0,8, 2,0,5},
-                    {4,0,0, 0,0,0, 3,1,0},
-                    {9,0,0, 0,0,0, 0,0,8},
-                    {0,1,5, 0,0,0, 0,0,4},
-                    {1,0,6, 9,0,0, 0,3,0},
-                    {0,0,0, 0,2,0, 0,6,0},
-                    {0,2,0, 4,0,0, 5,0,0}
-            },
-            {	// This one requires search
-                    {0,4,3, 0,8,0, 2,5,0},
-                    {6,0,0, 0,0,0, 0,0,0},
-                    {0,0,0, 0,0,1, 0,9,4},
-                    {9,0,0, 0,0,4, 0,7,0},
-                    {0,0,0, 6,0,8, 0,0,0},
-                    {0,1,0, 2,0,0, 0,0,3},
-                    {8,2,0, 5,0,0, 0,0,0},
-                    {0,0,0, 0,0,0, 0,0,5},
-                    {0,3,4, 0,9,0, 7,1,0}
-            },
-            {	// Hard one from http://www.cs.mu.oz.au/671/proj3/node5.html
-                    {0,0,0, 0,0,3, 0,6,0},
-                    {0,0,0, 0,0,0, 0,1,0},
-                    {0,9,7, 5,0,0, 0,8,0},
-                    {0,0,0, 0,9,0, 2,0,0},
-                    {0,0,8, 0,7,0, 4,0,0},
-                    {0,0,3, 0,6,0, 0,0,0},
-                    {0,1,0, 0,0,2, 8,9,0},
-                    {0,4,0, 0,0,0, 0,0,0},
-                    {0,5,0, 1,0,0, 0,0,0}
-            },
-            { // Puzzle 1 from http://www.sudoku.org.uk/bifurcation.htm
-                    {1,0,0, 9,0,7, 0,0,3},
-                    {0,8,0, 0,0,0, 0,7,0},
-                    {0,0,9, 0,0,0, 6,0,0},
-                    {0,0,7, 2,0,9, 4,0,0},
-                    {4,1,0, 0,0,0, 0,9,5},
-                    {0,0,8, 5,0,4, 3,0,0},
-                    {0,0,3, 0,0,0, 7,0,0},
-                    {0,5,0, 0,0,0, 0,4,0},
-                    {2,0,0, 8,0,6, 0,0,9}
-            },
-            { // Puzzle 2 from http://www.sudoku.org.uk/bifurcation.htm
-                    {0,0,0, 3,0,2, 0,0,0},
-                    {0,5,0, 7,9,8, 0,3,0},
-                    {0,0,7, 0,0,0, 8,0,0},
-                    {0,0,8, 6,0,7, 3,0,0},
-                    {0,7,0, 0,0,0, 0,6,0},
-                    {0,0,3, 5,0,4, 1,0,0},
-                    {0,0,5, 0,0,0, 6,0,0},
-                    {0,2,0, 4,1,9, 0,5,0},
-                    {0,0,0, 8,0,6, 0,0,0}
-            },
-            { // Puzzle 3 from http://www.sudoku.org.uk/bifurcation.htm
-                    {0,0,0, 8,0,0, 0,0,6},
-                    {0,0,1, 6,2,0, 4,3,0},
-                    {4,0,0, 0,7,1, 0,0,2},
-                    {0,0,7, 2,0,0, 0,8,0},
-                    {0,0,0, 0,1,0, 0,0,0},
-                    {0,1,0, 0,0,6, 2,0,0},
-                    {1,0,0, 7,3,0, 0,0,4},
-                    {0,2,6, 0,4,8, 1,0,0},
-                    {3,0,0, 0,0,5, 0,0,0}
-            },
-            { // Puzzle 4 from http://www.sudoku.org.uk/bifurcation.htm
-                    {3,0,5, 0,0,4, 0,7,0},
-                    {0,7,0, 0,0,0, 0,0,1},
-                    {0,4,0, 9,0,0, 0,3,0},
-                    {4,0,0, 0,5,1, 0,0,6},
-                    {0,9,0, 0,0,0, 0,4,0},
-                    {2,0,0, 8,4,0, 0,0,7},
-                    {0,2,0, 0,0,7, 0,6,0},
-                    {8,0,0, 0,0,0, 0,9,0},
-                    {0,6,0, 4,0,0, 2,0,8}
-            },
-            { // Puzzle 5 from http://www.sudoku.org.uk/bifurcation.htm
-                    {0,0,0, 7,0,0, 3,0,0},
-                    {0,6,0, 0,0,0, 5,7,0},
-                    {0,7,3, 8,0,0, 4,1,0},
-                    {0,0,9, 2,8,0, 0,0,0},
-                    {5,0,0, 0,0,0, 0,0,9},
-                    {0,0,0, 0,9,3, 6,0,0},
-                    {0,9,8, 0,0,7, 1,5,0},
-                    {0,5,4, 0,0,0, 0,6,0},
-                    {0,0,1, 0,0,9, 0,0,0}
-            },
-            { // Puzzle 6 from http://www.sudoku.org.uk/bifurcation.htm
-                    {0,0,0, 6,0,0, 0,0,4},
-                    {0,3,0, 0,9,0, 0,2,0},
-                    {0,6,0, 8,0,0, 7,0,0},
-                    {0,0,5, 0,6,0, 0,0,1},
-                    {6,7,0, 3,0,1, 0,5,8},
-                    {9,0,0, 0,5,0, 4,0,0},
-                    {0,0,6, 0,0,3, 0,9,0},
-                    {0,1,0, 0,8,0, 0,6,0},
-                    {2,0,0, 0,0,6, 0,0,0}
-            },
-            { // Puzzle 7 from http://www.sudoku.org.uk/bifurcation.htm
-                    {8,0,0, 0,0,1, 0,4,0},
-                    {2,0,6, 0,9,0, 0,1,0},
-                    {0,0,9, 0,0,6, 0,8,0},
-                    {1,2,4, 0,0,0, 0,0,9},
-                    {0,0,0, 0,0,0, 0,0,0},
-                    {9,0,0, 0,0,0, 8,2,4},
-                    {0,5,0, 4,0,0, 1,0,0},
-                    {0,8,0, 0,7,0, 2,0,5},
-                    {0,9,0, 5,0,0, 0,0,7}
-            },
-            { // Puzzle 8 from http://www.sudoku.org.uk/bifurcation.htm
-                    {6,5,2, 0,4,8, 0,0,7},
-                    {0,7,0, 2,0,5, 4,0,0},
-                    {0,0,0, 0,0,0, 0,0,0},
-                    {0,6,4, 1,0,0, 0,7,0},
-                    {0,0,0, 0,8,0, 0,0,0},
-                    {0,8,0, 0,0,4, 5,6,0},
-                    {0,0,0, 0,0,0, 0,0,0},
-                    {0,0,8, 6,0,7, 0,2,0},
-                    {2,0,0, 8,9,0, 7,5,1}
-            },
-            { // Puzzle 9 from http://www.sudoku.org.uk/bifurcation.htm
-                    {0,0,6, 0,0,2, 0,0,9},
-                    {1,0,0, 5,0,0, 0,2,0},
-                    {0,4,7, 3,0,6, 0,0,1},
-                    {0,0,0, 0,0,8, 0,4,0},
-                    {0,3,0, 0,0,0, 0,7,0},
-                    {0,1,0, 6,0,0, 0,0,0},
-                    {4,0,0, 8,0,3, 2,1,0},
-                    {0,6,0, 0,0,1, 0,0,4},
-                    {3,0,0, 4,0,0, 9,0,0}
-            },
-            { // Puzzle 10 from http://www.sudoku.org.uk/bifurcation.htm
-                    {0,0,4, 0,5,0, 9,0,0},
-                    {0,0,0, 0,7,0, 0,0,6},
-                    {3,7,0, 0,0,0, 0,0,2},
-                    {0,0,9, 5,0,0, 0,8,0},
-                    {0,0,1, 2,0,4, 3,0,0},
-                    {0,6,0, 0,0,9, 2,0,0},
-                    {2,0,0, 0,0,0, 0,9,3},
-                    {1,0,0, 0,4,0, 0,0,0},
-                    {0,0,6, 0,2,0, 7,0,0}
-            },
-            { // Puzzle 11 from http://www.sudoku.org.uk/bifurcation.htm
-                    {0,0,0, 0,3,0, 7,9,0},
-                    {3,0,0, 0,0,0, 0,0,5},
-                    {0,0,0, 4,0,7, 3,0,6},
-                    {0,5,3, 0,9,4, 0,7,0},
-                    {0,0,0, 0,7,0, 0,0,0},
-                    {0,1,0, 8,2,0, 6,4,0},
-                    {7,0,1, 9,0,8, 0,0,0},
-                    {8,0,0, 0,0,0, 0,0,1},
-                    {0,9,4, 0,1,0, 0,0,0}
-            },
-            { // From http://www.sudoku.org.uk/discus/messages/29/51.html?1131034031
-                    {2,5,8, 1,0,4, 0,3,7},
-                    {9,3,6, 8,2,7, 5,1,4},
-                    {4,7,1, 5,3,0, 2,8,0},
-                    {7,1,5, 2,0,3, 0,4,0},
-                    {8,4,9, 6,7,5, 3,2,1},
-                    {3,6,2, 4,1,0, 0,7,5},
-                    {1,2,4, 9,0,0, 7,5,3},
-                    {5,9,3, 7,4,2, 1,6,8},
-                    {6,8,7, 3,5,1, 4,9,2}
-            }
-    };
-}
+// Options for choosing and batching puzzles
+class SudokuOptions : public DriverOptions {
+protected:
+    // Whether to solve all puzzles from the given one on
+    Driver::BoolOption _batch;
+    // Whether to carry the afc of each cell over to the next puzzle
+    Driver::BoolOption _warm;
+    // Whether to escalate the propagation strength per puzzle
+    Driver::BoolOption _adaptive;
+    // Fail limit of each propagation level but the strongest
+    Driver::UnsignedIntOption _adaptiveFails;
+    // Puzzle database to read the puzzles from, the examples by default
+    Driver::StringValueOption _puzzles;
+    // The opened database
+    mutable std::unique_ptr<PuzzleDB> database;
+
+    const PuzzleDB& db() const {
+        if (database == NULL)
+            database.reset(new PuzzleDB(_puzzles.value()));
+        return *database;
+    }
+public:
+    SudokuOptions(const char* s)
+            : DriverOptions(s),
+              _batch("batch", "solve all puzzles from the given one on", false),
+              _warm("warm", "start each puzzle of a batch with the afc learned so far, needs -batch", false),
+              _adaptive("adaptive", "start with value propagation and escalate on the fail limit", false),
+              _adaptiveFails("adaptive-fails", "fail limit of each propagation level but the strongest", 10),
+              _puzzles("puzzles", "puzzle database to take the puzzles from (see puzzledb)", EXAMPLES_DB) {
+        add(_batch);
+        add(_warm);
+        add(_adaptive);
+        add(_adaptiveFails);
+        add(_puzzles);
+    }
+
+    bool batch() const { return _batch.value(); }
+    bool warm() const { return _warm.value(); }
+    bool adaptive() const { return _adaptive.value(); }
+    unsigned int adaptiveFails() const { return _adaptiveFails.value(); }
+
+    // Number of puzzles to choose from
+    unsigned long int puzzles() const {
+        return db().size();
+    }
+    // The givens of puzzle id, 0 for an empty cell
+    void puzzle(unsigned long int id, int cells[9][9]) const {
+        db().get(id, &cells[0][0]);
+    }
+};
 
 class Sudoku : public Script {
 protected:
     IntVarArray matrixData; //data in the matrix
+    // Failure counts per cell carried over from earlier puzzles of a batch
+    SharedArray<double> warmAfc;
+    // Counts this space among the spaces alive
+    Accounting::Live live;
+
+    // The merits branch every puzzle of a batch, with or without carried
+    // counts, so that -warm changes only the counts and not the heuristic.
+    // The afc of the variables is not decayed, -decay applies to the
+    // counts carried from one puzzle to the next.
+    //
+    // Merit of a cell: its afc plus the carried counts, over its size
+    static double warmAfcSize(const Space& home, IntVar x, int i) {
+        return (x.afc() + static_cast<const Sudoku&>(home).warmAfc[i]) / x.size();
+    }
+    // Merit of a cell: its afc plus the carried counts
+    static double warmAfcMax(const Space& home, IntVar x, int i) {
+        return x.afc() + static_cast<const Sudoku&>(home).warmAfc[i];
+    }
 public:
     // Branching variants
     enum {
@@ -217,34 +104,51 @@ public:
         BRANCH_SIZE_AFC,    ///< Use minimum size over afc
         BRANCH_AFC          ///< Use maximum afc
     };
+    // Propagation variants
+    enum {
+        PROP_GECODE,        ///< Use Gecode's distinct with the -ipl level
+        PROP_BITSET         ///< Use the bitset all-different propagator
+    };
+
+    // Post that all variables in x take distinct values
+    void allDifferent(const IntVarArgs& x, const SizeOptions& opt) {
+        if (opt.propagation() == PROP_BITSET) {
+            bit_distinct(*this, x);
+        } else {
+            distinct(*this, x, opt.ipl());
+        }
+    }
+
+    //Constructor, warm holds the afc of each cell learned from earlier puzzles,
+    //all zero for the first puzzle of a batch, and puzzle replaces the example
+    //selected by the size option
+    Sudoku(const SudokuOptions& opt, const double* warm = NULL, const int (*puzzle)[9] = NULL)
+            : Script(opt), matrixData(*this, 9*9, 1, 9), warmAfc(9*9) {
+        for (int i = 0; i < 9*9; i++)
+            warmAfc[i] = warm != NULL ? warm[i] : 0;
 
-    //Constructor
-    Sudoku(const SizeOptions& opt) : Script(opt),
-                                     matrixData(*this, 9*9, 1, 9) {
         //Create the m interface of the array, to make use of .col and .row
         Matrix<IntVarArray> m(matrixData, 9, 9);
 
         // Constraints for rows and columns
         for (int rowIndex = 0; rowIndex < 9; rowIndex++) {
-            distinct(*this, m.row(rowIndex), opt.ipl());
-            distinct(*this, m.col(rowIndex), opt.ipl());
+            allDifferent(m.row(rowIndex), opt);
+            allDifferent(m.col(rowIndex), opt);
         }
 
         // Constraints for squares
         for (int rowIndex = 0; rowIndex < 9; rowIndex += 3) {
             for (int colIndex = 0; colIndex < 9; colIndex += 3) {
-                distinct(*this, m.slice(rowIndex, rowIndex + 3, colIndex, colIndex + 3), opt.ipl());
+                allDifferent(m.slice(rowIndex, rowIndex + 3, colIndex, colIndex + 3), opt);
             }
         }
         //Fill in predefined values
-        for (int rowIndex = 0; rowIndex < 9; ++rowIndex) {
-            for (int colIndex = 0; colIndex < 9; ++colIndex) {
-              int cellValue = examples[opt.size()][rowIndex][colIndex];
-                if(cellValue != 0) {
-                    rel(*this, m(colIndex,rowIndex), IRT_EQ, cellValue);
-                }
-            }
+        int cells[9][9];
+        if (puzzle == NULL) {
+            opt.puzzle(opt.size(), cells);
+            puzzle = cells;
         }
+        givens(puzzle);
 
         //branching options
         if (opt.branching() == BRANCH_NONE) {
@@ -253,26 +157,116 @@ public:
             branch(*this, matrixData, INT_VAR_SIZE_MIN(), INT_VAL_SPLIT_MIN());
         } else if (opt.branching() == BRANCH_SIZE_DEGREE) {
             branch(*this, matrixData, INT_VAR_DEGREE_SIZE_MAX(), INT_VAL_SPLIT_MIN());
+        } else if (opt.branching() == BRANCH_SIZE_AFC && warm != NULL) {
+            branch(*this, matrixData, INT_VAR_MERIT_MAX(&warmAfcSize), INT_VAL_SPLIT_MIN());
         } else if (opt.branching() == BRANCH_SIZE_AFC) {
             branch(*this, matrixData, INT_VAR_AFC_SIZE_MAX(opt.decay()), INT_VAL_SPLIT_MIN());
+        } else if (opt.branching() == BRANCH_AFC && warm != NULL) {
+            branch(*this, matrixData, INT_VAR_MERIT_MAX(&warmAfcMax), INT_VAL_SPLIT_MIN());
         } else if (opt.branching() == BRANCH_AFC) {
             branch(*this, matrixData, INT_VAR_AFC_MAX(opt.decay()), INT_VAL_SPLIT_MIN());
         }
     }
+    // Post the predefined values of puzzle, 0 for an empty cell
+    void givens(const int (*puzzle)[9]) {
+        Matrix<IntVarArray> m(matrixData, 9, 9);
+        for (int rowIndex = 0; rowIndex < 9; ++rowIndex) {
+            for (int colIndex = 0; colIndex < 9; ++colIndex) {
+                int cellValue = puzzle[rowIndex][colIndex];
+                if(cellValue != 0) {
+                    rel(*this, m(colIndex,rowIndex), IRT_EQ, cellValue);
+                }
+            }
+        }
+    }
+
+    // Write the model of the example selected by opt as FlatZinc
+    static void flatzinc(std::ostream& os, const SudokuOptions& opt) {
+        int puzzle[9][9];
+        opt.puzzle(opt.size(), puzzle);
+        FlatZinc fz;
+        std::vector<std::string> cells;
+        for (int i = 0; i < 9*9; i++) {
+            std::ostringstream name;
+            name << "cell_" << i / 9 << "_" << i % 9;
+            cells.push_back(fz.var(name.str(), 1, 9));
+        }
+        fz.output("cells", cells);
+
+        // The bitset propagator is domain consistent for units of nine
+        const char* ipl = opt.propagation() == PROP_BITSET ? "domain" :
+                          opt.ipl() == IPL_VAL ? "val" :
+                          opt.ipl() == IPL_BND ? "bounds" : "domain";
+        for (int unit = 0; unit < 9; unit++) {
+            std::vector<std::string> row, col, box;
+            for (int i = 0; i < 9; i++) {
+                row.push_back(cells[unit * 9 + i]);
+                col.push_back(cells[i * 9 + unit]);
+                box.push_back(cells[(unit / 3 * 3 + i / 3) * 9 + unit % 3 * 3 + i % 3]);
+            }
+            fz.constraint("all_different_int(" + FlatZinc::list(row) + ")", ipl);
+            fz.constraint("all_different_int(" + FlatZinc::list(col) + ")", ipl);
+            fz.constraint("all_different_int(" + FlatZinc::list(box) + ")", ipl);
+        }
+
+        for (int i = 0; i < 9*9; i++) {
+            int cellValue = puzzle[i / 9][i % 9];
+            if (cellValue != 0) {
+                std::ostringstream c;
+                c << "int_eq(" << cells[i] << ", " << cellValue << ")";
+                fz.constraint(c.str());
+            }
+        }
+
+        // The closest FlatZinc variable selection to each branching
+        const char* var = "input_order";
+        if (opt.branching() == BRANCH_SIZE) {
+            var = "first_fail";
+        } else if (opt.branching() == BRANCH_SIZE_DEGREE) {
+            var = "most_constrained";
+        } else if (opt.branching() == BRANCH_SIZE_AFC) {
+            var = "dom_w_deg";
+        } else if (opt.branching() == BRANCH_AFC) {
+            var = "afc_max";
+        }
+        fz.finish(os, FlatZinc::search(cells, var, "indomain_split"));
+    }
+
     /// Constructor
     // Copy constructor
     Sudoku(bool share, Sudoku& s) : Script(share, s) {
         matrixData.update(*this, share, s.matrixData);
+        warmAfc.update(*this, share, s.warmAfc);
+    }
+
+    // Count the variables of the space
+    void account(Accounting& a) const {
+        a.vars("IntVar", matrixData.size());
+    }
+
+    // The afc of each cell, counting the failures of all clones of this space
+    void afc(double* counts) const {
+        for (int i = 0; i < 9*9; i++)
+            counts[i] = matrixData[i].afc();
     }
 
     // Copy method
     virtual Space* copy(bool share) {
+        CloneStats::record(*this);
         return new Sudoku(share, *this);
     }
 
     /// Print solution
     virtual void
     print(std::ostream& os) const {
+        SolutionWriter& writer = SolutionWriter::global();
+        if (writer.active()) {
+            std::vector<int> cells(81);
+            for (int i = 0; i<81; i++)
+                cells[i] = matrixData[i].val();
+            writer.write(cells);
+            return;
+        }
         os << "  ";
         for (int i = 0; i<81; i++) {
             if (matrixData[i].assigned()) {
@@ -290,8 +284,118 @@ public:
     }
 };
 
+// Propagation levels of -adaptive, from the cheapest to the strongest
+namespace {
+    struct Level {
+        const char* name;
+        int propagation;
+        IntPropLevel ipl;
+    };
+
+    const Level levels[] = {
+            {"val",    Sudoku::PROP_GECODE, IPL_VAL},
+            {"bnd",    Sudoku::PROP_GECODE, IPL_BND},
+            {"dom",    Sudoku::PROP_GECODE, IPL_DOM},
+            {"bitset", Sudoku::PROP_BITSET, IPL_DOM}
+    };
+
+    const int numberOfLevels = sizeof(levels) / sizeof(levels[0]);
+}
+
+// Solve the puzzles from opt.size() on in one process, with -warm every
+// puzzle starts from the decayed failure counts of the puzzles before it,
+// without it from zero counts.
+//
+// With -adaptive every puzzle is first solved with value propagation and
+// a fail limit. When the limit is hit the puzzle is solved again from the
+// start at the next stronger level, up to the bitset propagator without a
+// limit. The level that solved each puzzle is reported with its latency.
+void batch(SudokuOptions& opt) {
+    double warm[9*9] = {};
+    double learned[9*9];
+    unsigned long int nodes = 0, fails = 0;
+    unsigned long int solvedAt[numberOfLevels] = {};
+    double totalMs = 0, maxMs = 0;
+    const int propagation = opt.propagation();
+    const IntPropLevel ipl = opt.ipl();
+    const unsigned long int first = opt.size();
+    const unsigned long int last = opt.batch() ? opt.puzzles() : first + 1;
+    std::cout << "puzzle solutions      nodes   failures         ms"
+              << (opt.adaptive() ? "  level" : "") << std::endl;
+    for (unsigned long int puzzle = first; puzzle < last; puzzle++) {
+        opt.size(puzzle);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        unsigned long int puzzleNodes = 0, puzzleFails = 0;
+        unsigned int solutions = 0;
+        Sudoku* root = NULL;
+        int level = opt.adaptive() ? 0 : numberOfLevels - 1;
+        for (; level < numberOfLevels; level++) {
+            if (opt.adaptive()) {
+                opt.propagation(levels[level].propagation);
+                opt.ipl(levels[level].ipl);
+            }
+            delete root;
+            // Without -warm the counts stay zero, so both runs use the
+            // same branching
+            root = new Sudoku(opt, warm);
+            Search::Options so;
+            so.threads = opt.threads();
+            so.c_d = opt.c_d();
+            so.a_d = opt.a_d();
+            std::unique_ptr<Search::FailStop> stop;
+            if (opt.adaptive() && level < numberOfLevels - 1) {
+                stop.reset(new Search::FailStop(opt.adaptiveFails()));
+                so.stop = stop.get();
+            }
+            DFS<Sudoku> e(root, so);
+            solutions = 0;
+            while (Sudoku* s = e.next()) {
+                delete s;
+                if (++solutions == opt.solutions())
+                    break;
+            }
+            Search::Statistics stat = e.statistics();
+            puzzleNodes += stat.node;
+            puzzleFails += stat.fail;
+            if (!e.stopped())
+                break;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        nodes += puzzleNodes;
+        fails += puzzleFails;
+        totalMs += ms;
+        maxMs = std::max(maxMs, ms);
+        std::printf("%6lu %9u %10lu %10lu %10.3f", puzzle, solutions, puzzleNodes, puzzleFails, ms);
+        if (opt.adaptive()) {
+            solvedAt[level]++;
+            std::printf("  %s", levels[level].name);
+        }
+        std::printf("\n");
+        if (opt.warm()) {
+            root->afc(learned);
+            for (int i = 0; i < 9*9; i++)
+                warm[i] = opt.decay() * warm[i] + learned[i];
+        }
+        delete root;
+    }
+    opt.propagation(propagation);
+    opt.ipl(ipl);
+    std::cout << std::endl
+              << "Summary" << std::endl
+              << "\tnodes:        " << nodes << std::endl
+              << "\tfailures:     " << fails << std::endl
+              << "\tmean:         " << totalMs / std::max(last - first, 1UL) << " ms" << std::endl
+              << "\tmax:          " << maxMs << " ms" << std::endl;
+    if (opt.adaptive()) {
+        std::cout << "\tsolved at:" << std::endl;
+        for (int l = 0; l < numberOfLevels; l++)
+            std::cout << "\t\t" << levels[l].name << ": " << solvedAt[l] << std::endl;
+    }
+}
+
+#ifndef SOLVERD
     int main(int argc, char* argv[]) {
-        SizeOptions opt("Sudoku");
+        SudokuOptions opt("Sudoku");
         opt.size(0);
         opt.ipl(IPL_DOM);
         opt.solutions(0);
@@ -301,6 +405,35 @@ public:
         opt.branching(Sudoku::BRANCH_SIZE_DEGREE, "sizedeg", "min size over degree");
         opt.branching(Sudoku::BRANCH_SIZE_AFC, "sizeafc", "min size over afc");
         opt.branching(Sudoku::BRANCH_AFC, "afc", "maximum afc");
+        opt.propagation(Sudoku::PROP_GECODE);
+        opt.propagation(Sudoku::PROP_GECODE, "gecode", "Gecode's distinct with the -ipl level");
+        opt.propagation(Sudoku::PROP_BITSET, "bitset", "bitset all-different with Hall sets");
         opt.parse(argc,argv);
-        Script::run<Sudoku,DFS,SizeOptions>(opt);
+        // The counts are only carried from one puzzle of a batch to the next
+        if (opt.warm() && !opt.batch())
+            throw std::runtime_error("-warm needs -batch");
+        if (opt.flatzinc() != NULL) {
+            std::ofstream fz(opt.flatzinc());
+            Sudoku::flatzinc(fz, opt);
+            return 0;
+        }
+        CloneStats::enable(opt.cloneStats());
+        SolutionWriter::global().open(opt.output(), opt.outputFile(), 9);
+        if (opt.calibrate() > 0)
+            calibrate<Sudoku>(opt);
+        Accounting::start<Sudoku>(opt);
+        if (opt.batch() || opt.adaptive()) {
+            batch(opt);
+        } else if (opt.trace() != NULL) {
+            runWithTrace<Sudoku,SudokuOptions>(opt);
+        } else if (opt.progress() > 0) {
+            runWithProgress<Sudoku,DFS,SudokuOptions>(opt);
+        } else {
+            Script::run<Sudoku,DFS,SudokuOptions>(opt);
+        }
+        SolutionWriter::global().close();
+        Accounting::finish(opt, "Sudoku");
+        if (opt.cloneStats())
+            CloneStats::print(std::cout);
     }
+#endif
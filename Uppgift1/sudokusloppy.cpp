@@ -2,8 +2,8 @@
 #include <gecode/driver.hh>
 #include <gecode/minimodel.hh>
 
-//The file including the examples
-#include "boards.cpp"
+//The database with the examples
+#include "puzzledb.hh"
 
 using namespace Gecode;
 
@@ -69,9 +69,10 @@ public:
                 }
             }
 
-            std::cout << std::endl;
+            // No flush per line, the stream is flushed at exit
+            std::cout << '\n';
             if (isHorizontal) {
-                std::cout << "----------+-----------+------------" << std::endl;
+                std::cout << "----------+-----------+------------\n";
             }
         }
     }
@@ -92,13 +93,17 @@ void solveBoard(int board[9][9]) {
 }
 
 // Main function
-// Loop over all examples defined in "boards.cpp", solving
+// Loop over all examples in the database given as argument, by default
+// the examples built from examples.txt, solving
 int main(int argc, char* argv[]) {
-    int numExamples = sizeof(examples) / sizeof(examples[0]);
+    PuzzleDB examples(argc > 1 ? argv[1] : EXAMPLES_DB);
+    int numExamples = examples.size();
     for (int boardIdx = 0; boardIdx < numExamples; boardIdx++) {
+        int board[9][9];
+        examples.get(boardIdx, &board[0][0]);
         std::cout << std::endl;
         std::cout << "Example idx " << boardIdx << ":" << std::endl;
-        solveBoard(examples[boardIdx]);
+        solveBoard(board);
     }
 
 
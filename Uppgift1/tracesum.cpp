@@ -0,0 +1,179 @@
+// Summarize a search-tree trace written with -trace
+//
+//   tracesum <trace> [top] [depth]
+//
+// Prints the totals of the trace, the heaviest path from the root, always
+// following the child subtree with the most propagation time, and the top
+// subtrees rooted at the given depth by propagation time and by failures.
+// With a sampled trace the costs of the written nodes are scaled by the
+// sampling rate. See trace-format.hh for the file format.
+
+#include "trace-format.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Costs of the subtree below a node
+struct Cost {
+    unsigned long int nodes;
+    unsigned long int fails;
+    unsigned long int solutions;
+    double ns;
+    Cost() : nodes(0), fails(0), solutions(0), ns(0) {}
+};
+
+std::vector<Trace::Node> nodes;
+std::vector<std::string> choices;
+std::vector<Cost> costs;
+// Index of the parent of every node, -1 for the root
+std::vector<long int> parents;
+
+// Index of the node with the given id
+long int find(uint64_t id) {
+    Trace::Node key;
+    key.id = id;
+    std::vector<Trace::Node>::const_iterator i =
+            std::lower_bound(nodes.begin(), nodes.end(), key,
+                             [](const Trace::Node& a, const Trace::Node& b) { return a.id < b.id; });
+    return i != nodes.end() && i->id == id ? i - nodes.begin() : -1;
+}
+
+// The choices from the root to node i
+std::string path(long int i) {
+    std::vector<std::string> p;
+    for (; i >= 0; i = parents[i]) {
+        if (!choices[i].empty())
+            p.push_back(choices[i]);
+    }
+    std::string s;
+    for (size_t k = p.size(); k > 0; k--)
+        s += (k < p.size() ? " / " : "") + p[k - 1];
+    return s.empty() ? "(root)" : s;
+}
+
+void row(long int i, double scale) {
+    std::printf("%10lu %6u %12.0f %10.0f %12.3f  %s\n",
+                static_cast<unsigned long int>(nodes[i].id), nodes[i].depth,
+                costs[i].nodes * scale, costs[i].fails * scale, costs[i].ns * scale / 1e6,
+                path(i).c_str());
+}
+
+void header() {
+    std::printf("%10s %6s %12s %10s %12s  %s\n", "node", "depth", "nodes", "failures", "ms", "choices");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "usage: " << argv[0] << " <trace> [top] [depth]" << std::endl;
+        return 2;
+    }
+    size_t top = argc > 2 ? std::atoi(argv[2]) : 10;
+    unsigned int depth = argc > 3 ? std::atoi(argv[3]) : 3;
+
+    std::ifstream in(argv[1], std::ios::binary);
+    Trace::Header h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) ||
+        std::memcmp(h.magic, Trace::MAGIC, sizeof(h.magic)) != 0) {
+        std::cerr << "not a trace: " << argv[1] << std::endl;
+        return 1;
+    }
+    Trace::Node n;
+    uint16_t length;
+    while (in.read(reinterpret_cast<char*>(&n), sizeof(n)) &&
+           in.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+        std::string choice(length, '\0');
+        if (length > 0 && !in.read(&choice[0], length))
+            break;
+        nodes.push_back(n);
+        choices.push_back(choice);
+    }
+    if (nodes.empty()) {
+        std::cerr << "empty trace: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    // Nodes come after their parents, so the costs of every subtree are
+    // complete when it is added to its parent
+    costs.resize(nodes.size());
+    parents.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++)
+        parents[i] = nodes[i].parent == Trace::NONE ? -1 : find(nodes[i].parent);
+    for (size_t k = nodes.size(); k > 0; k--) {
+        size_t i = k - 1;
+        costs[i].nodes++;
+        costs[i].fails += nodes[i].outcome == Trace::FAILED;
+        costs[i].solutions += nodes[i].outcome == Trace::SOLVED;
+        costs[i].ns += nodes[i].ns;
+        if (parents[i] >= 0) {
+            Cost& p = costs[parents[i]];
+            p.nodes += costs[i].nodes;
+            p.fails += costs[i].fails;
+            p.solutions += costs[i].solutions;
+            p.ns += costs[i].ns;
+        }
+    }
+
+    double scale = h.sample;
+    Cost total;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (parents[i] < 0) {
+            total.nodes += costs[i].nodes;
+            total.fails += costs[i].fails;
+            total.solutions += costs[i].solutions;
+            total.ns += costs[i].ns;
+        }
+    }
+    std::cout << "trace " << argv[1] << std::endl
+              << "\tsampling:     every " << h.sample << " nodes" << std::endl
+              << "\ttraced nodes: " << nodes.size() << std::endl
+              << "\tnodes:        " << total.nodes * scale << std::endl
+              << "\tfailures:     " << total.fails * scale << std::endl
+              << "\tsolutions:    " << total.solutions * scale << std::endl
+              << "\tpropagation:  " << total.ns * scale / 1e6 << " ms" << std::endl;
+
+    std::vector<std::vector<long int> > children(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (parents[i] >= 0)
+            children[parents[i]].push_back(i);
+    }
+
+    std::cout << std::endl << "Heaviest path" << std::endl;
+    header();
+    for (long int i = 0; i >= 0;) {
+        row(i, scale);
+        long int next = -1;
+        for (size_t c = 0; c < children[i].size(); c++) {
+            if (next < 0 || costs[children[i][c]].ns > costs[next].ns)
+                next = children[i][c];
+        }
+        i = next;
+    }
+
+    std::vector<long int> roots;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].depth == depth)
+            roots.push_back(i);
+    }
+    size_t k = std::min(top, roots.size());
+
+    std::cout << std::endl << "Top subtrees at depth " << depth << " by propagation time" << std::endl;
+    std::partial_sort(roots.begin(), roots.begin() + k, roots.end(),
+                      [](long int a, long int b) { return costs[a].ns > costs[b].ns; });
+    header();
+    for (size_t i = 0; i < k; i++)
+        row(roots[i], scale);
+
+    std::cout << std::endl << "Top subtrees at depth " << depth << " by failures" << std::endl;
+    std::partial_sort(roots.begin(), roots.begin() + k, roots.end(),
+                      [](long int a, long int b) { return costs[a].fails > costs[b].fails; });
+    header();
+    for (size_t i = 0; i < k; i++)
+        row(roots[i], scale);
+    return 0;
+}
@@ -0,0 +1,241 @@
+// Microbenchmark of the no-overlap propagator on random instances
+//
+// For every number of rectangles a seeded random set of rectangles is
+// generated, with sides 1..-max-side and an enclosing square with room
+// for about -fill percent more area than the rectangles need. For every
+// density, each iteration places that percentage of the rectangles at
+// random positions without overlap in a clone of the propagated root, and
+// times the fixpoint computation of that clone. The propagator is the
+// only one in the space, so the time is spent in the propagator and in
+// the kernel scheduling it.
+//
+// Reported per number of rectangles and density:
+//   props/fix   propagator executions per fixpoint
+//   ns/prop     time per propagator execution
+//   pruned      values removed from the domains per execution, over the
+//               fixpoints that did not fail
+//   expensive   percentage of the executions running the quadratic stage
+//   failed      percentage of the placements found infeasible
+//
+// Sorted by number of rectangles, the rows of a density are the scaling
+// curve of the propagator at that density. -scalar runs the scalar
+// pairwise kernel on a CPU with AVX2, for comparing the two.
+
+#include <gecode/driver.hh>
+#include <gecode/int.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <vector>
+
+// The no-overlap propagator
+#include "no-overlap.cpp"
+
+using namespace Gecode;
+using namespace Gecode::Int;
+
+class BenchOptions : public BaseOptions {
+protected:
+    // Numbers of rectangles, separated by commas
+    Driver::StringValueOption _rectangles;
+    // Percentages of rectangles placed, separated by commas
+    Driver::StringValueOption _densities;
+    // Placements timed per number of rectangles and density
+    Driver::UnsignedIntOption _iterations;
+    // Largest side of a rectangle
+    Driver::UnsignedIntOption _maxSide;
+    // Free area of the enclosing square in percent of the rectangles' area
+    Driver::UnsignedIntOption _fill;
+    // Seed of the instances and placements
+    Driver::UnsignedIntOption _seed;
+    // Whether to use the scalar kernel even on CPUs with AVX2
+    Driver::BoolOption _scalar;
+public:
+    BenchOptions(const char* s)
+            : BaseOptions(s),
+              _rectangles("rectangles", "numbers of rectangles, separated by commas", "10,20,50,100,200,500"),
+              _densities("densities", "percentages of rectangles placed, separated by commas", "0,10,25,50,75,90"),
+              _iterations("iterations", "placements timed per number of rectangles and density", 1000),
+              _maxSide("max-side", "largest side of a rectangle", 10),
+              _fill("fill", "free area of the enclosing square in percent", 25),
+              _seed("seed", "seed of the instances and placements", 1),
+              _scalar("scalar", "use the scalar pairwise kernel even with AVX2", false) {
+        add(_rectangles);
+        add(_densities);
+        add(_iterations);
+        add(_maxSide);
+        add(_fill);
+        add(_seed);
+        add(_scalar);
+    }
+
+    // The numbers in a comma separated list
+    static std::vector<int> list(const char* s) {
+        std::vector<int> v;
+        std::istringstream is(s);
+        std::string item;
+        while (std::getline(is, item, ','))
+            v.push_back(std::atoi(item.c_str()));
+        return v;
+    }
+
+    std::vector<int> rectangles() const { return list(_rectangles.value()); }
+    std::vector<int> densities() const { return list(_densities.value()); }
+    unsigned int iterations() const { return _iterations.value(); }
+    unsigned int maxSide() const { return _maxSide.value(); }
+    unsigned int fill() const { return _fill.value(); }
+    unsigned int seed() const { return _seed.value(); }
+    bool scalar() const { return _scalar.value(); }
+};
+
+// Random rectangles to place inside an enclosing square
+struct Rectangles {
+    std::vector<int> w, h;
+    int side;
+
+    Rectangles(int n, const BenchOptions& opt, std::mt19937& random) {
+        std::uniform_int_distribution<int> length(1, opt.maxSide());
+        long int area = 0;
+        for (int i = 0; i < n; i++) {
+            w.push_back(length(random));
+            h.push_back(length(random));
+            area += w.back() * h.back();
+        }
+        side = (int) std::ceil(std::sqrt(area * (100.0 + opt.fill()) / 100.0));
+        side = std::max(side, (int) opt.maxSide());
+    }
+};
+
+// A space holding only the coordinates and the no-overlap propagator
+class Instance : public Space {
+protected:
+    IntVarArray x;
+    IntVarArray y;
+public:
+    Instance(const Rectangles& r)
+            : x(*this, r.w.size(), 0, r.side), y(*this, r.w.size(), 0, r.side) {
+        for (int i = 0; i < x.size(); i++) {
+            rel(*this, x[i], IRT_LQ, r.side - r.w[i]);
+            rel(*this, y[i], IRT_LQ, r.side - r.h[i]);
+        }
+        no_overlap(*this, x, IntArgs(r.w), y, IntArgs(r.h));
+    }
+
+    Instance(bool share, Instance& s) : Space(share, s) {
+        x.update(*this, share, s.x);
+        y.update(*this, share, s.y);
+    }
+
+    virtual Space* copy(bool share) {
+        return new Instance(share, *this);
+    }
+
+    // Place rectangle i at (px, py), without propagating
+    void place(int i, int px, int py) {
+        rel(*this, x[i], IRT_EQ, px);
+        rel(*this, y[i], IRT_EQ, py);
+    }
+
+    // Sum of the domain sizes of all coordinates
+    unsigned long int values() const {
+        unsigned long int s = 0;
+        for (int i = 0; i < x.size(); i++)
+            s += x[i].size() + y[i].size();
+        return s;
+    }
+};
+
+// Random positions for the given percentage of the rectangles, without
+// overlap among them, as triples of rectangle, x and y
+std::vector<int> placement(const Rectangles& r, int density, std::mt19937& random) {
+    int n = r.w.size();
+    std::vector<int> order(n);
+    for (int i = 0; i < n; i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), random);
+    std::vector<int> placed;
+    for (int k = 0; k < n * density / 100; k++) {
+        int i = order[k];
+        std::uniform_int_distribution<int> px(0, r.side - r.w[i]);
+        std::uniform_int_distribution<int> py(0, r.side - r.h[i]);
+        // Give up on a rectangle that does not fit after some tries
+        for (int attempt = 0; attempt < 100; attempt++) {
+            int xi = px(random), yi = py(random);
+            bool overlap = false;
+            for (size_t p = 0; p < placed.size() && !overlap; p += 3) {
+                int j = placed[p], xj = placed[p + 1], yj = placed[p + 2];
+                overlap = xi < xj + r.w[j] && xj < xi + r.w[i] &&
+                          yi < yj + r.h[j] && yj < yi + r.h[i];
+            }
+            if (!overlap) {
+                placed.push_back(i);
+                placed.push_back(xi);
+                placed.push_back(yi);
+                break;
+            }
+        }
+    }
+    return placed;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions opt("no-overlap-bench");
+    opt.parse(argc, argv);
+    if (opt.scalar())
+        NoOverlap::vectorized = false;
+    std::printf("kernel: %s\n", NoOverlap::vectorized ? "avx2" : "scalar");
+    std::mt19937 random(opt.seed());
+    std::vector<int> densities = opt.densities();
+
+    std::printf("%6s %8s %10s %10s %10s %10s %10s\n",
+                "rects", "density", "props/fix", "ns/prop", "pruned", "expensive", "failed");
+    std::vector<int> rectangles = opt.rectangles();
+    for (size_t r = 0; r < rectangles.size(); r++) {
+        Rectangles instance(rectangles[r], opt, random);
+        Instance* root = new Instance(instance);
+        if (root->status() == SS_FAILED) {
+            std::printf("%6d %8s\n", rectangles[r], "failed");
+            delete root;
+            continue;
+        }
+        for (size_t d = 0; d < densities.size(); d++) {
+            unsigned long int propagations = 0, pruned = 0, prunedCalls = 0, failures = 0;
+            unsigned long int expensive = NoOverlap::expensiveStages;
+            std::chrono::nanoseconds time(0);
+            for (unsigned int i = 0; i < opt.iterations(); i++) {
+                std::vector<int> placed = placement(instance, densities[d], random);
+                Instance* s = static_cast<Instance*>(root->clone());
+                for (size_t p = 0; p < placed.size(); p += 3)
+                    s->place(placed[p], placed[p + 1], placed[p + 2]);
+                unsigned long int before = s->values();
+                StatusStatistics stat;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                SpaceStatus status = s->status(stat);
+                time += std::chrono::steady_clock::now() - start;
+                propagations += stat.propagate;
+                if (status == SS_FAILED) {
+                    failures++;
+                } else {
+                    pruned += before - s->values();
+                    prunedCalls += stat.propagate;
+                }
+                delete s;
+            }
+            expensive = NoOverlap::expensiveStages - expensive;
+            double calls = std::max(propagations, 1UL);
+            std::printf("%6d %7d%% %10.2f %10.1f %10.2f %9.1f%% %9.1f%%\n",
+                        rectangles[r], densities[d],
+                        (double) propagations / opt.iterations(),
+                        time.count() / calls, (double) pruned / std::max(prunedCalls, 1UL),
+                        100.0 * expensive / calls,
+                        100.0 * failures / opt.iterations());
+        }
+        delete root;
+    }
+    return 0;
+}
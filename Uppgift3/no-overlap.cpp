@@ -28,33 +28,64 @@
 
 #include <gecode/int.hh>
 
+#include <atomic>
+
+#if defined(NO_OVERLAP_AVX2)
+#include <immintrin.h>
+#endif
+
 using namespace Gecode;
 using namespace Gecode::Int;
 
 // The no-overlap propagator
+//
+// Propagation is staged. Every bounds event runs a cheap linear stage that
+// checks the area of the rectangles against their bounding box. Only when
+// some rectangle is placed, and pairwise pruning can thus find anything,
+// is the propagator rescheduled for the expensive quadratic stage.
+//
+// The expensive stage copies the bounds into contiguous arrays and tests
+// one rectangle against eight others at a time (with AVX2, otherwise one
+// at a time). Only the pairs where pruning can happen reach the views.
+// With NO_OVERLAP_AVX2 defined the AVX2 kernel is compiled for that
+// instruction set alone, and used only when the CPU supports it.
+//
+// With NO_OVERLAP_STATS defined the executions of both stages are counted
+// in counters shared by all threads, otherwise nothing is counted.
 class NoOverlap : public Propagator {
+public:
+    // Whether the AVX2 kernel is used, on CPUs with AVX2 by default
+    static bool vectorized;
+#if defined(NO_OVERLAP_STATS)
+    // Number of executions of the cheap stage
+    static std::atomic<unsigned long int> cheapStages;
+    // Number of executions of the expensive stage
+    static std::atomic<unsigned long int> expensiveStages;
+#endif
 protected:
     // The x-coordinates
     ViewArray<IntView> x;
-    // The width (array)
-    int* w;
+    // The widths, shared between all clones
+    SharedArray<int> w;
     // The y-coordinates
     ViewArray<IntView> y;
-    // The heights (array)
-    int* h;
+    // The heights, shared between all clones
+    SharedArray<int> h;
 public:
     // Create propagator and initialize
     NoOverlap(Home home,
-              ViewArray<IntView>& x0, int w0[],
-              ViewArray<IntView>& y0, int h0[])
+              ViewArray<IntView>& x0, const SharedArray<int>& w0,
+              ViewArray<IntView>& y0, const SharedArray<int>& h0)
             : Propagator(home), x(x0), w(w0), y(y0), h(h0) {
         x.subscribe(home,*this,PC_INT_BND);
         y.subscribe(home,*this,PC_INT_BND);
+        // The shared arrays must be released on disposal
+        home.notice(*this,AP_DISPOSE);
     }
     // Post no-overlap propagator
     static ExecStatus post(Home home,
-                           ViewArray<IntView>& x, int w[],
-                           ViewArray<IntView>& y, int h[]) {
+                           ViewArray<IntView>& x, const SharedArray<int>& w,
+                           ViewArray<IntView>& y, const SharedArray<int>& h) {
         // Only if there is something to propagate
         if (x.size() > 1)
             (void) new (home) NoOverlap(home,x,w,y,h);
@@ -66,12 +97,9 @@ public:
             : Propagator(home,share,p) {
         x.update(home,share,p.x);
         y.update(home,share,p.y);
-        // Also copy width and height arrays
-        w = home.alloc<int>(x.size());
-        h = home.alloc<int>(y.size());
-        for (int i=x.size(); i--; ) {
-            w[i]=p.w[i]; h[i]=p.h[i];
-        }
+        // The widths and heights never change, so they are shared
+        w.update(home,share,p.w);
+        h.update(home,share,p.h);
     }
     // Create copy during cloning
     virtual Propagator* copy(Space& home, bool share) {
@@ -84,61 +112,181 @@ public:
         y.reschedule(home,*this,PC_INT_BND);
     }
 
-    // Return cost (defined as cheap quadratic)
-    virtual PropCost cost(const Space&, const ModEventDelta&) const {
-        return PropCost::quadratic(PropCost::LO,2*x.size());
+    // Return cost, the expensive stage is scheduled with ME_INT_DOM
+    virtual PropCost cost(const Space&, const ModEventDelta& med) const {
+        if (IntView::me(med) == ME_INT_DOM)
+            return PropCost::quadratic(PropCost::HI,2*x.size());
+        return PropCost::linear(PropCost::LO,2*x.size());
     }
 
-    bool isOverlapping(int a, int u) {
-        bool isAssignedRightOfUnassigned = x[a].min() >= x[u].max() + w[u];
-        bool isAssignedLeftOfUnassigned = x[a].max() + w[a] <= x[u].min();
-        bool isAssignedUnderOfUnassigned = y[a].min() >= y[u].max() + h[u];
-        bool isAssignedOverOfUnassigned = y[a].max() + h[a] <= y[u].min();
-        bool isOverlappingHorizontally = !isAssignedRightOfUnassigned && !isAssignedLeftOfUnassigned;
-        bool isOverlappingVertically = !isAssignedUnderOfUnassigned && !isAssignedOverOfUnassigned;
-        return isOverlappingHorizontally && isOverlappingVertically;
+    // Bounds of all rectangles as structure of arrays
+    struct Bounds {
+        int* xMin; int* xMax; int* yMin; int* yMax;
+        int* w; int* h;
+        // All bits set if the coordinate is assigned, otherwise 0
+        int* xFixed; int* yFixed;
+    };
+
+    // Copy the bounds of rectangle i
+    void gather(Bounds& b, int i) const {
+        b.xMin[i] = x[i].min(); b.xMax[i] = x[i].max();
+        b.yMin[i] = y[i].min(); b.yMax[i] = y[i].max();
+        b.xFixed[i] = x[i].assigned() ? -1 : 0;
+        b.yFixed[i] = y[i].assigned() ? -1 : 0;
+    }
+
+#if defined(NO_OVERLAP_AVX2)
+    // pairs() for eight rectangles with AVX2, only called on CPUs with it
+    __attribute__((target("avx2")))
+    static void pairs8(const Bounds& b, int a, int u,
+                       unsigned int& overlap, unsigned int& interact) {
+        __m256i xMinA = _mm256_set1_epi32(b.xMin[a]);
+        __m256i yMinA = _mm256_set1_epi32(b.yMin[a]);
+        __m256i xEndA = _mm256_set1_epi32(b.xMax[a] + b.w[a]);
+        __m256i yEndA = _mm256_set1_epi32(b.yMax[a] + b.h[a]);
+        __m256i xMinU = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.xMin + u));
+        __m256i yMinU = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.yMin + u));
+        __m256i xEndU = _mm256_add_epi32(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.xMax + u)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.w + u)));
+        __m256i yEndU = _mm256_add_epi32(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.yMax + u)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.h + u)));
+        __m256i horizontal = _mm256_and_si256(_mm256_cmpgt_epi32(xEndU, xMinA),
+                                              _mm256_cmpgt_epi32(xEndA, xMinU));
+        __m256i vertical = _mm256_and_si256(_mm256_cmpgt_epi32(yEndU, yMinA),
+                                            _mm256_cmpgt_epi32(yEndA, yMinU));
+        __m256i xFixed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.xFixed + u));
+        __m256i yFixed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.yFixed + u));
+        __m256i both = _mm256_and_si256(horizontal, vertical);
+        __m256i fixed = _mm256_or_si256(_mm256_and_si256(yFixed, vertical),
+                                        _mm256_and_si256(xFixed, horizontal));
+        overlap = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(both)));
+        interact = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(fixed)));
+    }
+#endif
+
+    // Test rectangle a against the n rectangles from u, at most 8.
+    // Bit i of overlap is set if a and u+i may overlap, bit i of interact
+    // if u+i has an assigned coordinate and overlaps a along that axis.
+    static void pairs(const Bounds& b, int a, int u, int n,
+                      unsigned int& overlap, unsigned int& interact) {
+#if defined(NO_OVERLAP_AVX2)
+        if (n == 8 && vectorized) {
+            pairs8(b, a, u, overlap, interact);
+            return;
+        }
+#endif
+        overlap = interact = 0;
+        for (int i = 0; i < n; i++) {
+            int v = u + i;
+            bool horizontal = b.xMax[v] + b.w[v] > b.xMin[a] && b.xMax[a] + b.w[a] > b.xMin[v];
+            bool vertical = b.yMax[v] + b.h[v] > b.yMin[a] && b.yMax[a] + b.h[a] > b.yMin[v];
+            if (horizontal && vertical)
+                overlap |= 1u << i;
+            if ((b.yFixed[v] && vertical) || (b.xFixed[v] && horizontal))
+                interact |= 1u << i;
+        }
+    }
+
+    // Prune u against the placed rectangle a
+    ExecStatus prune(Space& home, int a, int u) {
+        // When one square is assigned, and one axis of the other square is assigned
+        // values are removed for the unassigned axis
+        if (y[u].assigned()) {
+            bool isAssignedUnderOfUnassigned = y[a].val() >= y[u].val() + h[u];
+            bool isAssignedOverOfUnassigned = y[a].val() + h[a] <= y[u].val();
+            bool isOverlappingVertically = !isAssignedUnderOfUnassigned && !isAssignedOverOfUnassigned;
+
+            // If the squares are overlapping vertically, remove all values where
+            // they are overlapping horizontally
+            if (isOverlappingVertically) {
+                for (int i = x[a].val() - w[u] + 1; i < x[a].val() + w[a]; i++) {
+                    GECODE_ME_CHECK(x[u].nq(home, i));
+                }
+            }
+        }
+
+        if (x[u].assigned()) {
+            bool isAssignedRightOfUnassigned = x[a].val() >= x[u].val() + w[u];
+            bool isAssignedLeftOfUnassigned = x[a].val() + w[a] <= x[u].val();
+            bool isOverlappingHorizontally = !isAssignedRightOfUnassigned && !isAssignedLeftOfUnassigned;
+            // If the squares are overlapping horizontally, remove all values where
+            // they are overlapping vertically
+            if (isOverlappingHorizontally) {
+                for (int i = y[a].val() - h[u] + 1; i < y[a].val() + h[a]; i++) {
+                    GECODE_ME_CHECK(y[u].nq(home, i));
+                }
+            }
+        }
+        return ES_OK;
+    }
+
+    // Cheap stage: the rectangles must fit into their bounding box
+    ExecStatus propagateBounds(Space& home) {
+#if defined(NO_OVERLAP_STATS)
+        cheapStages.fetch_add(1, std::memory_order_relaxed);
+#endif
+        int minX = x[0].min(), maxX = x[0].max() + w[0];
+        int minY = y[0].min(), maxY = y[0].max() + h[0];
+        long long int area = 0;
+        bool placed = false;
+        for (int i = 0; i < x.size(); i++) {
+            minX = std::min(minX, x[i].min());
+            maxX = std::max(maxX, x[i].max() + w[i]);
+            minY = std::min(minY, y[i].min());
+            maxY = std::max(maxY, y[i].max() + h[i]);
+            area += static_cast<long long int>(w[i]) * h[i];
+            placed = placed || (x[i].assigned() && y[i].assigned());
+        }
+        if (area > static_cast<long long int>(maxX - minX) * (maxY - minY))
+            return ES_FAILED;
+
+        // Pairwise pruning needs a placed rectangle
+        if (!placed)
+            return ES_FIX;
+        return home.ES_FIX_PARTIAL(*this, IntView::med(ME_INT_DOM));
     }
 
     // Perform propagation
-    virtual ExecStatus propagate(Space& home, const ModEventDelta&) {
+    virtual ExecStatus propagate(Space& home, const ModEventDelta& med) {
+        if (IntView::me(med) != ME_INT_DOM)
+            return propagateBounds(home);
+
+#if defined(NO_OVERLAP_STATS)
+        expensiveStages.fetch_add(1, std::memory_order_relaxed);
+#endif
         bool overlapFound = false;
 
-        for (int a = 0; a < x.size(); a++) {
-            for (int u = a + 1; u < x.size(); u++) {
+        int n = x.size();
+        Region r(home);
+        Bounds b;
+        b.xMin = r.alloc<int>(n); b.xMax = r.alloc<int>(n);
+        b.yMin = r.alloc<int>(n); b.yMax = r.alloc<int>(n);
+        b.xFixed = r.alloc<int>(n); b.yFixed = r.alloc<int>(n);
+        b.w = &w[0]; b.h = &h[0];
+        for (int i = 0; i < n; i++)
+            gather(b, i);
+
+        for (int a = 0; a < n; a++) {
+            bool placed = b.xFixed[a] && b.yFixed[a];
+            // Once an overlap is found only placed squares have work left
+            if (overlapFound && !placed)
+                continue;
+            for (int u = a + 1; u < n; u += 8) {
+                unsigned int overlap, interact;
+                pairs(b, a, u, std::min(8, n - u), overlap, interact);
                 // Check if any squares are overlapping, for reporting subsumption
-                if (isOverlapping(a, u)) {
+                if (overlap != 0)
                     overlapFound = true;
-                }
-
-                // When one square is assigned, and one axis of the other square is assigned
-                // values are removed for the unassigned axis
-                if(x[a].assigned() && y[a].assigned()) {
-                    if (y[u].assigned()) {
-                        bool isAssignedUnderOfUnassigned = y[a].val() >= y[u].val() + h[u];
-                        bool isAssignedOverOfUnassigned = y[a].val() + h[a] <= y[u].val();
-                        bool isOverlappingVertically = !isAssignedUnderOfUnassigned && !isAssignedOverOfUnassigned;
-
-                        // If the squares are overlapping vertically, remove all values where
-                        // they are overlapping horizontally
-                        if (isOverlappingVertically) {
-                            for (int i = x[a].val() - w[u] + 1; i < x[a].val() + w[a]; i++) {
-                                GECODE_ME_CHECK(x[u].nq(home, i));
-                            }
-                        }
-                    }
-
-                    if (x[u].assigned()) {
-                        bool isAssignedRightOfUnassigned = x[a].val() >= x[u].val() + w[u];
-                        bool isAssignedLeftOfUnassigned = x[a].val() + w[a] <= x[u].val();
-                        bool isOverlappingHorizontally = !isAssignedRightOfUnassigned && !isAssignedLeftOfUnassigned;
-                        // If the squares are overlapping horizontally, remove all values where
-                        // they are overlapping vertically
-                        if (isOverlappingHorizontally) {
-                            for (int i = y[a].val() - h[u] + 1; i < y[a].val() + h[a]; i++) {
-                                GECODE_ME_CHECK(y[u].nq(home, i));
-                            }
-                        }
-                    }
+                if (!placed)
+                    continue;
+                while (interact != 0) {
+                    int i = __builtin_ctz(interact);
+                    interact &= interact - 1;
+                    GECODE_ES_CHECK(prune(home, a, u + i));
+                    // Keep the copied bounds in sync for the remaining pairs
+                    gather(b, u + i);
                 }
             }
         }
@@ -154,11 +302,25 @@ public:
     virtual size_t dispose(Space& home) {
         x.cancel(home,*this,PC_INT_BND);
         y.cancel(home,*this,PC_INT_BND);
+        home.ignore(*this,AP_DISPOSE);
+        w.~SharedArray<int>();
+        h.~SharedArray<int>();
         (void) Propagator::dispose(home);
         return sizeof(*this);
     }
 };
 
+#if defined(NO_OVERLAP_AVX2)
+bool NoOverlap::vectorized = __builtin_cpu_supports("avx2");
+#else
+bool NoOverlap::vectorized = false;
+#endif
+
+#if defined(NO_OVERLAP_STATS)
+std::atomic<unsigned long int> NoOverlap::cheapStages(0);
+std::atomic<unsigned long int> NoOverlap::expensiveStages(0);
+#endif
+
 /*
  * Post the constraint that the rectangles defined by the coordinates
  * x and y and width w and height h do not overlap.
@@ -178,12 +340,9 @@ void no_overlap(Home home,
     // Set up array of views for the coordinates
     ViewArray<IntView> vx(home,x);
     ViewArray<IntView> vy(home,y);
-    // Set up arrays (allocated in home) for width and height and initialize
-    int* wc = static_cast<Space&>(home).alloc<int>(x.size());
-    int* hc = static_cast<Space&>(home).alloc<int>(y.size());
-    for (int i=x.size(); i--; ) {
-        wc[i]=w[i]; hc[i]=h[i];
-    }
+    // Set up shared arrays for width and height
+    SharedArray<int> wc(w);
+    SharedArray<int> hc(h);
     // If posting failed, fail space
     if (NoOverlap::post(home,vx,wc,vy,hc) != ES_OK)
         home.fail();
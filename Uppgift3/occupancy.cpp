@@ -0,0 +1,338 @@
+// The occupancy-grid propagator for packing fixed-size squares
+//
+// The propagator keeps a bitmap of the cells covered by placed squares,
+// one array of 64-bit words per row, which is copied with the space. From
+// the free cells it computes, with word-level shifts and ANDs, every
+// position where each unplaced square still fits and prunes the
+// coordinates of that square to those positions. It fails as soon as the
+// free cells that some unplaced square can still cover are fewer than the
+// area of the unplaced squares, so pockets too small for any remaining
+// square count as lost.
+
+#include <gecode/int.hh>
+
+#include <cstdint>
+
+using namespace Gecode;
+using namespace Gecode::Int;
+
+class Occupancy : public Propagator {
+protected:
+    // The x-coordinates
+    ViewArray<IntView> x;
+    // The y-coordinates
+    ViewArray<IntView> y;
+    // The sizes, shared between all clones
+    SharedArray<int> s;
+    // The size of the enclosing square
+    IntView side;
+    // Number of rows and columns of the grid
+    int cells;
+    // Number of words per row
+    int words;
+    // The occupied cells, words per row
+    uint64_t* grid;
+    // Whether square i is part of the grid
+    bool* placed;
+
+    // Set bits [from, from + n) of row
+    static void set(uint64_t* row, int from, int n) {
+        for (int i = from; i < from + n; i++)
+            row[i / 64] |= uint64_t(1) << (i % 64);
+    }
+
+    // Whether any of the bits [from, from + n) of row is set
+    static bool any(const uint64_t* row, int from, int n) {
+        for (int i = from; i < from + n; i++)
+            if (row[i / 64] & (uint64_t(1) << (i % 64)))
+                return true;
+        return false;
+    }
+
+    // dst = src >> k, bit p of dst is bit p + k of src
+    void shift(const uint64_t* src, uint64_t* dst, int k) const {
+        int ws = k / 64, bs = k % 64;
+        for (int i = 0; i < words; i++) {
+            uint64_t lo = i + ws < words ? src[i + ws] : 0;
+            uint64_t hi = i + ws + 1 < words ? src[i + ws + 1] : 0;
+            dst[i] = bs == 0 ? lo : (lo >> bs) | (hi << (64 - bs));
+        }
+    }
+
+    // dst = src << k, bit p of dst is bit p - k of src
+    void spread(const uint64_t* src, uint64_t* dst, int k) const {
+        int ws = k / 64, bs = k % 64;
+        for (int i = 0; i < words; i++) {
+            uint64_t lo = i - ws >= 0 ? src[i - ws] : 0;
+            uint64_t hi = i - ws - 1 >= 0 ? src[i - ws - 1] : 0;
+            dst[i] = bs == 0 ? lo : (lo << bs) | (hi >> (64 - bs));
+        }
+    }
+
+    // The words of a row with bits [0, n) set
+    void mask(uint64_t* row, int n) const {
+        for (int i = 0; i < words; i++) {
+            if (n >= 64 * (i + 1))
+                row[i] = ~uint64_t(0);
+            else if (n <= 64 * i)
+                row[i] = 0;
+            else
+                row[i] = (uint64_t(1) << (n - 64 * i)) - 1;
+        }
+    }
+
+    // The words of a row with the bits of the values of v set
+    void values(uint64_t* row, IntView v) const {
+        for (int i = 0; i < words; i++)
+            row[i] = 0;
+        for (ViewRanges<IntView> r(v); r(); ++r) {
+            int from = std::max(r.min(), 0);
+            int to = std::min(r.max(), cells - 1);
+            if (from <= to)
+                set(row, from, to - from + 1);
+        }
+    }
+
+public:
+    // Create propagator and initialize
+    Occupancy(Home home,
+              ViewArray<IntView>& x0, ViewArray<IntView>& y0, const SharedArray<int>& s0,
+              IntView side0, int cells0, uint64_t* grid0, bool* placed0)
+            : Propagator(home), x(x0), y(y0), s(s0), side(side0),
+              cells(cells0), words((cells0 + 63) / 64), grid(grid0), placed(placed0) {
+        x.subscribe(home,*this,PC_INT_VAL);
+        y.subscribe(home,*this,PC_INT_VAL);
+        side.subscribe(home,*this,PC_INT_BND);
+        // The shared sizes must be released on disposal
+        home.notice(*this,AP_DISPOSE);
+    }
+
+    // Post occupancy propagator
+    static ExecStatus post(Home home,
+                           ViewArray<IntView>& x, ViewArray<IntView>& y, const SharedArray<int>& s,
+                           IntView side) {
+        if (x.size() == 0)
+            return ES_OK;
+        int cells = side.max();
+        int words = (cells + 63) / 64;
+        uint64_t* grid = static_cast<Space&>(home).alloc<uint64_t>(cells * words);
+        bool* placed = static_cast<Space&>(home).alloc<bool>(x.size());
+        for (int i = cells * words; i--; )
+            grid[i] = 0;
+        for (int i = x.size(); i--; )
+            placed[i] = false;
+        (void) new (home) Occupancy(home,x,y,s,side,cells,grid,placed);
+        return ES_OK;
+    }
+
+    // Copy constructor during cloning
+    Occupancy(Space& home, bool share, Occupancy& p)
+            : Propagator(home,share,p), cells(p.cells), words(p.words) {
+        x.update(home,share,p.x);
+        y.update(home,share,p.y);
+        side.update(home,share,p.side);
+        // The sizes never change, so they are shared
+        s.update(home,share,p.s);
+        placed = home.alloc<bool>(x.size());
+        for (int i=x.size(); i--; ) {
+            placed[i]=p.placed[i];
+        }
+        grid = home.alloc<uint64_t>(cells * words);
+        for (int i=cells * words; i--; )
+            grid[i]=p.grid[i];
+    }
+    // Create copy during cloning
+    virtual Propagator* copy(Space& home, bool share) {
+        return new (home) Occupancy(home,share,*this);
+    }
+
+    // Re-schedule function after propagator has been re-enabled
+    virtual void reschedule(Space& home) {
+        x.reschedule(home,*this,PC_INT_VAL);
+        y.reschedule(home,*this,PC_INT_VAL);
+        side.reschedule(home,*this,PC_INT_BND);
+    }
+
+    // Return cost (defined as expensive linear, every square scans the grid)
+    virtual PropCost cost(const Space&, const ModEventDelta&) const {
+        return PropCost::linear(PropCost::HI,x.size());
+    }
+
+    // Perform propagation
+    virtual ExecStatus propagate(Space& home, const ModEventDelta&) {
+        // Add the newly placed squares to the grid
+        for (int i = 0; i < x.size(); i++) {
+            if (placed[i] || !x[i].assigned() || !y[i].assigned())
+                continue;
+            if (x[i].val() + s[i] > cells || y[i].val() + s[i] > cells)
+                return ES_FAILED;
+            for (int row = y[i].val(); row < y[i].val() + s[i]; row++) {
+                if (any(grid + row * words, x[i].val(), s[i]))
+                    return ES_FAILED;
+                set(grid + row * words, x[i].val(), s[i]);
+            }
+            placed[i] = true;
+        }
+
+        // Only the cells inside the largest possible enclosing square are usable
+        int width = std::min(side.max(), cells);
+        Region r(home);
+        uint64_t* board = r.alloc<uint64_t>(words);
+        mask(board, width);
+
+        // Empty cells per row
+        uint64_t* empty = r.alloc<uint64_t>(cells * words);
+        long long int area = 0;
+        for (int row = 0; row < cells; row++) {
+            for (int i = 0; i < words; i++) {
+                uint64_t f = row < width ? ~grid[row * words + i] & board[i] : 0;
+                empty[row * words + i] = f;
+                area += __builtin_popcountll(f);
+            }
+        }
+        for (int i = 0; i < x.size(); i++) {
+            if (!placed[i])
+                area -= static_cast<long long int>(s[i]) * s[i];
+        }
+        if (area < 0)
+            return ES_FAILED;
+
+        uint64_t* fit = r.alloc<uint64_t>(cells * words);
+        // The cells covered by a feasible position of square i, and of any
+        // unplaced square
+        uint64_t* reach = r.alloc<uint64_t>(cells * words);
+        uint64_t* usable = r.alloc<uint64_t>(cells * words);
+        for (int j = 0; j < cells * words; j++)
+            usable[j] = 0;
+        long long int needed = 0;
+        uint64_t* tmp = r.alloc<uint64_t>(words);
+        uint64_t* domain = r.alloc<uint64_t>(words);
+        uint64_t* columns = r.alloc<uint64_t>(words);
+        int* feasible = r.alloc<int>(cells);
+        for (int i = 0; i < x.size(); i++) {
+            if (placed[i])
+                continue;
+            int k = s[i];
+            needed += static_cast<long long int>(k) * k;
+
+            // Bit p of row r of fit: cells p..p+k-1 of rows r..r+k-1 are free.
+            // Both directions double the covered length with every step.
+            for (int j = 0; j < cells * words; j++)
+                fit[j] = empty[j];
+            for (int covered = 1; covered < k; ) {
+                int step = std::min(covered, k - covered);
+                for (int row = 0; row < cells; row++) {
+                    shift(fit + row * words, tmp, step);
+                    for (int j = 0; j < words; j++)
+                        fit[row * words + j] &= tmp[j];
+                }
+                covered += step;
+            }
+            for (int covered = 1; covered < k; ) {
+                int step = std::min(covered, k - covered);
+                for (int row = 0; row < cells; row++) {
+                    for (int j = 0; j < words; j++)
+                        fit[row * words + j] &= row + step < cells ? fit[(row + step) * words + j] : 0;
+                }
+                covered += step;
+            }
+
+            // Collect the feasible rows and the columns feasible in any of them
+            values(domain, x[i]);
+            for (int j = 0; j < words; j++)
+                columns[j] = 0;
+            int rows = 0;
+            for (int j = 0; j < cells * words; j++)
+                reach[j] = 0;
+            for (ViewValues<IntView> v(y[i]); v(); ++v) {
+                if (v.val() < 0 || v.val() >= cells)
+                    continue;
+                bool fits = false;
+                for (int j = 0; j < words; j++) {
+                    uint64_t c = fit[v.val() * words + j] & domain[j];
+                    reach[v.val() * words + j] = c;
+                    columns[j] |= c;
+                    fits = fits || c != 0;
+                }
+                if (fits)
+                    feasible[rows++] = v.val();
+            }
+            Iter::Values::Array ry(feasible, rows);
+            GECODE_ME_CHECK(y[i].inter_v(home, ry, false));
+
+            int cols = 0;
+            for (int j = 0; j < words; j++) {
+                for (uint64_t c = columns[j]; c != 0; c &= c - 1)
+                    feasible[cols++] = 64 * j + __builtin_ctzll(c);
+            }
+            Iter::Values::Array rx(feasible, cols);
+            GECODE_ME_CHECK(x[i].inter_v(home, rx, false));
+
+            // Grow the feasible positions into the cells the square covers,
+            // doubling the covered length with every step as for fit
+            for (int covered = 1; covered < k; ) {
+                int step = std::min(covered, k - covered);
+                for (int row = 0; row < cells; row++) {
+                    spread(reach + row * words, tmp, step);
+                    for (int j = 0; j < words; j++)
+                        reach[row * words + j] |= tmp[j];
+                }
+                covered += step;
+            }
+            for (int covered = 1; covered < k; ) {
+                int step = std::min(covered, k - covered);
+                for (int row = cells; row-- > step; ) {
+                    for (int j = 0; j < words; j++)
+                        reach[row * words + j] |= reach[(row - step) * words + j];
+                }
+                covered += step;
+            }
+            for (int j = 0; j < cells * words; j++)
+                usable[j] |= reach[j];
+        }
+
+        // Free cells no unplaced square can cover stay empty
+        long long int coverable = 0;
+        for (int j = 0; j < cells * words; j++)
+            coverable += __builtin_popcountll(usable[j]);
+        if (coverable < needed)
+            return ES_FAILED;
+        return ES_NOFIX;
+    }
+
+    // Dispose propagator and return its size
+    virtual size_t dispose(Space& home) {
+        x.cancel(home,*this,PC_INT_VAL);
+        y.cancel(home,*this,PC_INT_VAL);
+        side.cancel(home,*this,PC_INT_BND);
+        home.ignore(*this,AP_DISPOSE);
+        s.~SharedArray<int>();
+        (void) Propagator::dispose(home);
+        return sizeof(*this);
+    }
+};
+
+/*
+ * Post the constraint that the squares with coordinates x and y and
+ * sizes s fit without overlap into the enclosing square of size side.
+ *
+ * Meant to be posted together with no_overlap, which does the pairwise
+ * reasoning while this propagator reasons on the free area.
+ */
+void occupancy(Home home,
+               const IntVarArgs& x, const IntVarArgs& y, const IntArgs& s,
+               IntVar side) {
+    // Check whether the arguments make sense
+    if ((x.size() != y.size()) || (x.size() != s.size()))
+        throw ArgumentSizeMismatch("occupancy");
+    // Never post a propagator in a failed space
+    if (home.failed()) return;
+    // Set up array of views for the coordinates
+    ViewArray<IntView> vx(home,x);
+    ViewArray<IntView> vy(home,y);
+    // Set up shared array for the sizes
+    SharedArray<int> sc(s);
+    // If posting failed, fail space
+    if (Occupancy::post(home,vx,vy,sc,IntView(side)) != ES_OK)
+        home.fail();
+}
@@ -1,46 +1,240 @@
 #include <gecode/driver.hh>
 #include <gecode/int.hh>
 
+#include <sys/wait.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+
+#include "driver-options.hh"
+#include "accounting.hh"
+#include "recomputation.hh"
+#include "clone-stats.hh"
+#include "flatzinc.hh"
+#include "telemetry.hh"
+#include "trace.hh"
+
+// The file-based queue for work units
+#include "work-units.cpp"
+// The no-overlap propagator
+#include "no-overlap.cpp"
+// The occupancy-grid propagator
+#include "occupancy.cpp"
+
 using namespace Gecode;
 using namespace Gecode::Int;
 
-//Number of squares to place
+// Default value of N, the squares to place have the sizes N, ..., 2 (N-1 squares)
 const int N = 6;
 
-void no_overlap(Home home,
-                const IntVarArgs& x, const IntArgs& w,
-                const IntVarArgs& y, const IntArgs& h);
+class SquareOptions : public DriverOptions {
+protected:
+    // How the search is divided into work units
+    Driver::StringOption _workUnits;
+    // The directory of the work unit queue
+    Driver::StringValueOption _queue;
+    // The number of largest squares placed by each work unit
+    Driver::UnsignedIntOption _splitDepth;
+    // The number of worker processes
+    Driver::UnsignedIntOption _workers;
+    // Time budget for large neighbourhood search in milliseconds
+    Driver::UnsignedIntOption _lns;
+    // Fail limit for each neighbourhood
+    Driver::UnsignedIntOption _lnsFails;
+    // Percentage of the squares relaxed by a random neighbourhood
+    Driver::UnsignedIntOption _lnsRelax;
+    // Seed for choosing neighbourhoods
+    Driver::UnsignedIntOption _lnsSeed;
+    // File to log improving solutions to
+    Driver::StringValueOption _lnsLog;
+    // Sides of the squares, replacing N, ..., 2
+    Driver::StringValueOption _sizes;
+    // How much of the symmetry to break
+    Driver::StringOption _symmetry;
+public:
+    enum {
+        WORK_NONE,    /// Solve everything in a single search
+        WORK_SPLIT,   /// Split the search tree into work units
+        WORK_WORKER,  /// Solve work units from the queue
+        WORK_MERGE,   /// Merge the results of the work units
+        WORK_REQUEUE, /// Return the units of crashed workers to the queue
+    };
+
+    enum {
+        SYMMETRY_LARGEST, /// Place the largest square in one eighth of the board
+        SYMMETRY_FULL,    /// Also order equal squares and break the remaining board symmetries
+    };
+
+    SquareOptions(const char* s)
+            : DriverOptions(s),
+              _workUnits("work-units", "split the search into independent work units", WORK_NONE),
+              _queue("queue", "directory of the work unit queue", "square-queue"),
+              _splitDepth("split-depth", "number of largest squares placed by each work unit", 2),
+              _workers("workers", "number of worker processes", 1),
+              _lns("lns", "time budget for large neighbourhood search in ms (0 for a complete search)", 0),
+              _lnsFails("lns-fails", "fail limit for each neighbourhood", 500),
+              _lnsRelax("lns-relax", "percentage of squares relaxed by random neighbourhoods", 30),
+              _lnsSeed("lns-seed", "seed for choosing neighbourhoods", 1),
+              _lnsLog("lns-log", "file to log improving solutions to", NULL),
+              _sizes("sizes", "sides of the squares separated by commas, instead of N, ..., 2", NULL),
+              _symmetry("symmetry", "symmetry breaking", SYMMETRY_LARGEST) {
+        _workUnits.add(WORK_NONE, "none", "solve in a single search");
+        _workUnits.add(WORK_SPLIT, "split", "split the search tree into work units in the queue");
+        _workUnits.add(WORK_WORKER, "worker", "solve work units from the queue");
+        _workUnits.add(WORK_MERGE, "merge", "merge the results from the queue");
+        _workUnits.add(WORK_REQUEUE, "requeue", "return claimed work units to the queue, with no worker running");
+        add(_workUnits);
+        add(_queue);
+        add(_splitDepth);
+        add(_workers);
+        add(_lns);
+        add(_lnsFails);
+        add(_lnsRelax);
+        add(_lnsSeed);
+        add(_lnsLog);
+        add(_sizes);
+        _symmetry.add(SYMMETRY_LARGEST, "largest", "restrict the largest square only");
+        _symmetry.add(SYMMETRY_FULL, "full", "also order equal squares and break the remaining symmetries");
+        add(_symmetry);
+    }
+
+    int workUnits() const { return _workUnits.value(); }
+    const char* queue() const { return _queue.value(); }
+    unsigned int splitDepth() const { return _splitDepth.value(); }
+    unsigned int workers() const { return _workers.value(); }
+    unsigned int lns() const { return _lns.value(); }
+    unsigned int lnsFails() const { return _lnsFails.value(); }
+    unsigned int lnsRelax() const { return _lnsRelax.value(); }
+    unsigned int lnsSeed() const { return _lnsSeed.value(); }
+    const char* lnsLog() const { return _lnsLog.value(); }
+    int symmetry() const { return _symmetry.value(); }
+
+    // The sides of the squares from largest to smallest
+    std::vector<int> sizes() const {
+        std::vector<int> sides;
+        if (_sizes.value() == NULL) {
+            for (int i = size(); i > 1; i--) {
+                sides.push_back(i);
+            }
+        } else {
+            std::istringstream is(_sizes.value());
+            std::string side;
+            while (std::getline(is, side, ',')) {
+                sides.push_back(std::atoi(side.c_str()));
+            }
+            std::sort(sides.begin(), sides.end(), std::greater<int>());
+        }
+        return sides;
+    }
+};
 
 class Square : public Script {
 protected:
+    // The sides of the squares from largest to smallest
+    SharedArray<int> sides;
+    // N, the number of squares is N-1
+    int n;
     // the size of the surrounding square
     IntVar sizeOfSquare;
     // the x-coordinates for the packed squares
     IntVarArray xCoords;
     // the y-coordinates for the packed squares
     IntVarArray yCoords;
+    // the owner of every cell with the dual viewpoint, see dual()
+    IntVarArray owners;
+    // the cell of the top left corner of every square with the dual viewpoint
+    IntVarArray corners;
+    // Boolean variables posted for the reified constraints
+    int reified;
+    // Arrays of the sizes shared by all clones, the sides and the sizes of
+    // the propagators, counted once by the accounting and never per clone
+    int sharedArrays;
+    // Counts this space among the spaces alive
+    Accounting::Live live;
 public:
     /// Propagation to use for model
     enum {
         PROP_DEFAULT, /// Use default propagation
         PROP_SPECIAL_NO_OVERLAP_PROPAGATOR,   /// Use special no-overlap propagator
+        PROP_OCCUPANCY, /// Use special no-overlap and occupancy-grid propagators
+        PROP_DUAL, /// Use special no-overlap propagator and the dual owner matrix
+        PROP_HALF, /// Use a clause over half-reified pairwise relations
     };
 
-    // Hardcoded number of squares
-    static const int size(int i) {
-        return N - i;
+    // Size of square i, the squares are ordered from largest to smallest
+    int size(int i) const {
+        return sides[i];
     }
 
-    int smallestSide(int n) {
-        int sumOfSquares = 0;
-        for (int i = 1; i < n + 1; i++) {
-            sumOfSquares += i * i;
+    // The bounds count a 1x1 square. Of the squares N, ..., 1 the 1x1
+    // square always fits into some gap and is never placed.
+    static int smallestSide(const std::vector<int> &sizes) {
+        int sumOfSquares = 1;
+        for (size_t i = 0; i < sizes.size(); i++) {
+            sumOfSquares += sizes[i] * sizes[i];
         }
-        return (int) std::floor(std::sqrt(sumOfSquares));
+        int side = (int) std::floor(std::sqrt(sumOfSquares));
+        return sizes.empty() ? side : std::max(side, sizes[0]);
     }
 
-    int longestSide(int n) {
-        return n * (n + 1) / 2;
+    static int longestSide(const std::vector<int> &sizes) {
+        int sum = 1;
+        for (size_t i = 0; i < sizes.size(); i++) {
+            sum += sizes[i];
+        }
+        return sum;
+    }
+
+    // Whether the sides are N, ..., 2, the forbidden gaps only hold then
+    static bool consecutive(const std::vector<int> &sizes) {
+        for (size_t i = 0; i < sizes.size(); i++) {
+            if (sizes[i] != static_cast<int>(sizes.size() + 1 - i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The largest square other than the first with a size no other square
+    // has, -1 if there is none
+    static int loneSquare(const std::vector<int> &sizes) {
+        for (size_t i = 1; i < sizes.size(); i++) {
+            if (sizes[i] != sizes[i - 1] && (i + 1 == sizes.size() || sizes[i] != sizes[i + 1])) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // Distances from the border a square of size s never needs to be placed at
+    static std::vector<int> forbiddenGaps(int s) {
+        if (s == 45) {
+            return {10};
+        } else if (s >= 34) {
+            return {9};
+        } else if (s >= 30) {
+            return {8};
+        } else if (s >= 22) {
+            return {7};
+        } else if (s >= 18) {
+            return {6};
+        } else if (s >= 12) {
+            return {5};
+        } else if (s >= 9) {
+            return {4};
+        } else if (s >= 5) {
+            return {3};
+        } else if (s >= 4) {
+            return {2};
+        } else if (s >= 3) {
+            return {2, 3};
+        } else if (s >= 2) {
+            return {1, 2};
+        }
+        return {};
     }
 
     void forbidDistanceFromBorder(int squareIndex, int distanceFromBorder) {
@@ -48,68 +242,163 @@ public:
         rel(*this, yCoords[squareIndex] != distanceFromBorder);
     }
 
+    // The dual viewpoint: the owner of every cell of the largest possible
+    // enclosing square, 0 for an empty cell and i + 1 for a cell covered by
+    // square i.
+    //
+    // A cell is owned by square i exactly when the square covers its column
+    // and its row, so a cell taken by one square removes the coordinates
+    // covering it from all other squares. Every square owns as many cells as
+    // its area and the remaining cells are empty, and the cell of the top
+    // left corner of every square is channeled with element.
+    //
+    // The matrix has longestSide(N)^2 cells and a Boolean variable per cell
+    // and square, so it only pays off for small N.
+    void dual() {
+        int w = sizeOfSquare.max();
+        owners = IntVarArray(*this, w * w, 0, n - 1);
+        corners = IntVarArray(*this, n - 1, 0, w * w - 1);
+        Matrix<IntVarArray> owner(owners, w, w);
+        int area = 0;
+        for (int i = 0; i < n - 1; i++) {
+            BoolVarArgs inColumn(*this, w, 0, 1);
+            BoolVarArgs inRow(*this, w, 0, 1);
+            for (int c = 0; c < w; c++) {
+                dom(*this, xCoords[i], c - size(i) + 1, c, inColumn[c]);
+                dom(*this, yCoords[i], c - size(i) + 1, c, inRow[c]);
+            }
+            for (int row = 0; row < w; row++) {
+                for (int column = 0; column < w; column++) {
+                    BoolVar covers(*this, 0, 1);
+                    rel(*this, inColumn[column], BOT_AND, inRow[row], covers);
+                    rel(*this, owner(column, row), IRT_EQ, i + 1, covers);
+                }
+            }
+            reified += 2 * w + w * w;
+
+            count(*this, owners, i + 1, IRT_EQ, size(i) * size(i));
+            rel(*this, corners[i] == w * yCoords[i] + xCoords[i]);
+            element(*this, owners, corners[i], i + 1);
+            area += size(i) * size(i);
+        }
+        count(*this, owners, 0, IRT_EQ, w * w - area);
+    }
+
+    // Break the symmetries left by the restriction of the largest square.
+    //
+    // The largest square lies left of the vertical axis and above the
+    // diagonal. Lying on the axis or on the diagonal, it is mapped to itself
+    // by the reflection in it, so that reflection is broken on the lone
+    // square instead. The squares of equal size, other than the largest
+    // square, are interchangeable and ordered by their coordinates. The
+    // ordering never moves the largest or the lone square, so all of these
+    // hold together.
+    //
+    // The constraints are static rather than dynamic (LDSB): a reflection
+    // maps x to sizeOfSquare - size - x, which depends on the variable size
+    // of the enclosing square and the size of each square, and LDSB only
+    // takes fixed variable and value symmetries. Swapping two equal squares
+    // swaps x and y together, while x and y are branched on separately.
+    void breakSymmetries(const std::vector<int> &sizes) {
+        rel(*this, 2 * xCoords[0] + size(0) <= sizeOfSquare);
+
+        int lone = loneSquare(sizes);
+        if (lone > 0) {
+            rel(*this, (2 * xCoords[0] + size(0) == sizeOfSquare) >>
+                       (2 * xCoords[lone] + size(lone) <= sizeOfSquare));
+            rel(*this, (xCoords[0] == yCoords[0]) >> (yCoords[lone] <= xCoords[lone]));
+            reified += 4;
+        }
+
+        for (int i = 2; i < n - 1; i++) {
+            if (size(i) == size(i - 1)) {
+                rel(*this, IntVarArgs() << xCoords[i - 1] << yCoords[i - 1], IRT_LE,
+                    IntVarArgs() << xCoords[i] << yCoords[i]);
+            }
+        }
+    }
+
     // Constructor
-    Square(const SizeOptions &opt)
+    Square(const SquareOptions &opt)
             : Script(opt),
-              sizeOfSquare(*this, smallestSide(N), longestSide(N)),
-              xCoords(*this, N - 1, 0, sizeOfSquare.max() - 1),
-              yCoords(*this, N - 1, 0, sizeOfSquare.max() - 1) {
+              sides(IntArgs(opt.sizes())),
+              n(sides.size() + 1),
+              sizeOfSquare(*this, smallestSide(opt.sizes()), longestSide(opt.sizes())),
+              xCoords(*this, n - 1, 0, sizeOfSquare.max() - 1),
+              yCoords(*this, n - 1, 0, sizeOfSquare.max() - 1),
+              reified(0), sharedArrays(1) {
 
         // Constraint for "lower-right corner" to make sure the squares fit.
-        for (int i = 0; i < N - 1; i++) {
+        for (int i = 0; i < n - 1; i++) {
             rel(*this, yCoords[i] <= sizeOfSquare - size(i));
             rel(*this, xCoords[i] <= sizeOfSquare - size(i));
         }
 
         //Symmetry-break constraint for largest square
-        dom(*this, xCoords[0], 0, (int) (1 + std::floor((sizeOfSquare.max() -  size(0)) / 2)));
-        rel(*this, yCoords[0] <= xCoords[0]);
+        if (n > 1) {
+            dom(*this, xCoords[0], 0, (int) (1 + std::floor((sizeOfSquare.max() -  size(0)) / 2)));
+            rel(*this, yCoords[0] <= xCoords[0]);
+            if (opt.symmetry() == SquareOptions::SYMMETRY_FULL) {
+                breakSymmetries(opt.sizes());
+            }
+        }
 
         // Remove forbidden gaps from borders due to dominance
-        for (int i = 0; i < N - 1; i++) {
-            int s = size(i);
-            if (s == 45) {
-                forbidDistanceFromBorder(i, 10);
-            } else if (s >= 34) {
-                forbidDistanceFromBorder(i, 9);
-            } else if (s >= 30) {
-                forbidDistanceFromBorder(i, 8);
-            } else if (s >= 22) {
-                forbidDistanceFromBorder(i, 7);
-            } else if (s >= 18) {
-                forbidDistanceFromBorder(i, 6);
-            } else if (s >= 12) {
-                forbidDistanceFromBorder(i, 5);
-            } else if (s >= 9) {
-                forbidDistanceFromBorder(i, 4);
-            } else if (s >= 5) {
-                forbidDistanceFromBorder(i, 3);
-            } else if (s >= 4) {
-                forbidDistanceFromBorder(i, 2);
-            } else if (s >= 3) {
-                forbidDistanceFromBorder(i, 2);
-                forbidDistanceFromBorder(i, 3);
-            } else if (s >= 2) {
-                forbidDistanceFromBorder(i, 1);
-                forbidDistanceFromBorder(i, 2);
-            }
-        }
-
-        IntArgs sizesOfSquares(N - 1);
-        for (int i = 0; i < N - 1; i++) {
+        bool dominance = consecutive(opt.sizes());
+        for (int i = 0; i < n - 1 && dominance; i++) {
+            std::vector<int> gaps = forbiddenGaps(size(i));
+            for (size_t g = 0; g < gaps.size(); g++) {
+                forbidDistanceFromBorder(i, gaps[g]);
+            }
+        }
+
+        IntArgs sizesOfSquares(n - 1);
+        for (int i = 0; i < n - 1; i++) {
             sizesOfSquares[i] = size(i);
         }
 
         if (opt.propagation() == PROP_SPECIAL_NO_OVERLAP_PROPAGATOR) {
             // Constraint for non-overlapping squares.
             no_overlap(*this, xCoords, sizesOfSquares, yCoords, sizesOfSquares);
+            sharedArrays += 2;
+        } else if (opt.propagation() == PROP_DUAL) {
+            // Constraint for non-overlapping squares, also on the owners of the cells.
+            no_overlap(*this, xCoords, sizesOfSquares, yCoords, sizesOfSquares);
+            sharedArrays += 2;
+            dual();
+        } else if (opt.propagation() == PROP_HALF) {
+            // Constraint for non-overlapping squares: every pair is separated
+            // along at least one axis. Each Boolean variable only implies its
+            // relation, a violated relation sets it to false and the clause
+            // enforces the last relation left.
+            for (int square = 0; square < n - 1; square++) {
+                for (int otherSquare = square + 1; otherSquare < n - 1; otherSquare++) {
+                    BoolVarArgs separated(*this, 4, 0, 1);
+                    IntArgs difference(2, 1, -1);
+                    linear(*this, difference, IntVarArgs() << xCoords[square] << xCoords[otherSquare],
+                           IRT_LQ, -size(square), Reify(separated[0], RM_IMP));
+                    linear(*this, difference, IntVarArgs() << xCoords[otherSquare] << xCoords[square],
+                           IRT_LQ, -size(otherSquare), Reify(separated[1], RM_IMP));
+                    linear(*this, difference, IntVarArgs() << yCoords[square] << yCoords[otherSquare],
+                           IRT_LQ, -size(square), Reify(separated[2], RM_IMP));
+                    linear(*this, difference, IntVarArgs() << yCoords[otherSquare] << yCoords[square],
+                           IRT_LQ, -size(otherSquare), Reify(separated[3], RM_IMP));
+                    clause(*this, BOT_OR, separated, BoolVarArgs(), 1);
+                    reified += 4;
+                }
+            }
+        } else if (opt.propagation() == PROP_OCCUPANCY) {
+            // Constraint for non-overlapping squares, also reasoning on the free area.
+            no_overlap(*this, xCoords, sizesOfSquares, yCoords, sizesOfSquares);
+            occupancy(*this, xCoords, yCoords, sizesOfSquares, sizeOfSquare);
+            sharedArrays += 3;
         } else {
             // Constraint for non-overlapping squares.
-            for (int square = 0; square < N - 1; square++) {
+            for (int square = 0; square < n - 1; square++) {
                 // Cannot overlap with any smaller squares
                 // Since larger squares have already been checked in the previous
                 // runs of the loop they are unnecessary to check again.
-                for (int otherSquare = square + 1; otherSquare < N - 1; otherSquare++) {
+                for (int otherSquare = square + 1; otherSquare < n - 1; otherSquare++) {
                     BoolVar squareLeftOfOtherSquare(*this, 0, 1);
                     BoolVar otherSquareLeftOfSquare(*this, 0, 1);
 
@@ -131,16 +420,18 @@ public:
 
                     rel(*this, squareTopOfOtherSquare + otherSquareTopOfSquare + squareLeftOfOtherSquare +
                                otherSquareLeftOfSquare == 1);
+                    reified += 4;
                 }
             }
         }
 
         // Constraint for columns of x coordinates
-        for (int outer = 0; outer < N - 1; outer++) {
-            BoolVarArgs reifiedRows(*this, N - 1, 0, 1);
-            BoolVarArgs reifiedColumns(*this, N - 1, 0, 1);
+        for (int outer = 0; outer < n - 1; outer++) {
+            BoolVarArgs reifiedRows(*this, n - 1, 0, 1);
+            BoolVarArgs reifiedColumns(*this, n - 1, 0, 1);
+            reified += 2 * (n - 1);
 
-            for (int inner = 0; inner < N - 1; inner++) {
+            for (int inner = 0; inner < n - 1; inner++) {
                 // The x coordinate of all squares must be between
                 // the column index - size of square + 1 and column index
                 dom(*this, xCoords[inner], outer - size(inner) + 1, outer, reifiedRows[inner]);
@@ -157,40 +448,270 @@ public:
             linear(*this, sizesOfSquares, reifiedRows, IRT_LQ, sizeOfSquare);
         }
 
-        branch(*this, sizeOfSquare, INT_VAL_MIN());
-        branch(*this, xCoords, INT_VAR_MIN_MAX(), INT_VAL_MIN());
-        branch(*this, yCoords, INT_VAR_MIN_MAX(), INT_VAL_MIN());
+        if (opt.workUnits() == SquareOptions::WORK_SPLIT) {
+            // Only branch on what defines a work unit: the size of the
+            // enclosing square and the placement of the largest squares
+            IntVarArgs largest;
+            for (int i = 0; i < splitDepth(opt); i++) {
+                largest << xCoords[i] << yCoords[i];
+            }
+            branch(*this, sizeOfSquare, INT_VAL_MIN());
+            branch(*this, largest, INT_VAR_NONE(), INT_VAL_MIN());
+        } else if (opt.lns() > 0) {
+            // Any packing will do, the neighbourhoods tighten the size
+            branch(*this, sizeOfSquare, INT_VAL_MAX());
+            branch(*this, xCoords, INT_VAR_MIN_MAX(), INT_VAL_MIN());
+            branch(*this, yCoords, INT_VAR_MIN_MAX(), INT_VAL_MIN());
+        } else {
+            branch(*this, sizeOfSquare, INT_VAL_MIN());
+            branch(*this, xCoords, INT_VAR_MIN_MAX(), INT_VAL_MIN());
+            branch(*this, yCoords, INT_VAR_MIN_MAX(), INT_VAL_MIN());
+        }
+    }
+
+    // Write the model for the size and propagation of opt as FlatZinc
+    static void flatzinc(std::ostream &os, const SquareOptions &opt) {
+        std::vector<int> sizes = opt.sizes();
+        int n = sizes.size() + 1;
+        int longest = longestSide(sizes);
+        FlatZinc fz;
+        std::string side = fz.var("side", smallestSide(sizes), longest, true);
+        std::vector<std::string> x, y;
+        for (int i = 0; i < n - 1; i++) {
+            x.push_back(fz.var("x_" + std::to_string(i), 0, longest - 1));
+            y.push_back(fz.var("y_" + std::to_string(i), 0, longest - 1));
+        }
+        fz.output("x", x);
+        fz.output("y", y);
+
+        for (int i = 0; i < n - 1; i++) {
+            std::string s = std::to_string(-sizes[i]);
+            fz.constraint("int_lin_le([1, -1], [" + x[i] + ", " + side + "], " + s + ")");
+            fz.constraint("int_lin_le([1, -1], [" + y[i] + ", " + side + "], " + s + ")");
+            std::vector<int> gaps = consecutive(sizes) ? forbiddenGaps(sizes[i]) : std::vector<int>();
+            for (size_t g = 0; g < gaps.size(); g++) {
+                fz.constraint("int_ne(" + x[i] + ", " + std::to_string(gaps[g]) + ")");
+                fz.constraint("int_ne(" + y[i] + ", " + std::to_string(gaps[g]) + ")");
+            }
+        }
+        if (n > 1) {
+            fz.constraint("int_le(" + x[0] + ", " + std::to_string(1 + (longest - sizes[0]) / 2) + ")");
+            fz.constraint("int_le(" + y[0] + ", " + x[0] + ")");
+        }
+        if (n > 1 && opt.symmetry() == SquareOptions::SYMMETRY_FULL) {
+            std::string s0 = std::to_string(-sizes[0]);
+            fz.constraint("int_lin_le([2, -1], [" + x[0] + ", " + side + "], " + s0 + ")");
+            int lone = loneSquare(sizes);
+            if (lone > 0) {
+                std::string sl = std::to_string(-sizes[lone]);
+                std::string onAxis = fz.boolVar("on_axis");
+                std::string loneLeft = fz.boolVar("lone_left");
+                std::string onDiagonal = fz.boolVar("on_diagonal");
+                std::string loneAbove = fz.boolVar("lone_above");
+                fz.constraint("int_lin_eq_reif([2, -1], [" + x[0] + ", " + side + "], " + s0 + ", " + onAxis + ")");
+                fz.constraint("int_lin_le_reif([2, -1], [" + x[lone] + ", " + side + "], " + sl + ", " + loneLeft + ")");
+                fz.constraint("bool_clause([" + loneLeft + "], [" + onAxis + "])");
+                fz.constraint("int_eq_reif(" + x[0] + ", " + y[0] + ", " + onDiagonal + ")");
+                fz.constraint("int_le_reif(" + y[lone] + ", " + x[lone] + ", " + loneAbove + ")");
+                fz.constraint("bool_clause([" + loneAbove + "], [" + onDiagonal + "])");
+            }
+            for (int i = 2; i < n - 1; i++) {
+                if (sizes[i] == sizes[i - 1]) {
+                    // lex_less_int is a MiniZinc global, Gecode's FlatZinc
+                    // builtin for it is array_int_lt
+                    fz.constraint("array_int_lt([" + x[i - 1] + ", " + y[i - 1] + "], [" + x[i] + ", " + y[i] + "])");
+                }
+            }
+        }
+
+        if (opt.propagation() == PROP_DEFAULT) {
+            // Exactly one of the four relative positions of every pair
+            for (int a = 0; a < n - 1; a++) {
+                for (int b = a + 1; b < n - 1; b++) {
+                    std::string pair = std::to_string(a) + "_" + std::to_string(b);
+                    std::string left = fz.boolVar("left_" + pair);
+                    std::string right = fz.boolVar("right_" + pair);
+                    std::string above = fz.boolVar("above_" + pair);
+                    std::string below = fz.boolVar("below_" + pair);
+                    std::string sa = std::to_string(-sizes[a]), sb = std::to_string(-sizes[b]);
+                    fz.constraint("int_lin_le_reif([1, -1], [" + x[a] + ", " + x[b] + "], " + sa + ", " + left + ")");
+                    fz.constraint("int_lin_le_reif([1, -1], [" + x[b] + ", " + x[a] + "], " + sb + ", " + right + ")");
+                    fz.constraint("int_lin_le_reif([1, -1], [" + y[a] + ", " + y[b] + "], " + sa + ", " + above + ")");
+                    fz.constraint("int_lin_le_reif([1, -1], [" + y[b] + ", " + y[a] + "], " + sb + ", " + below + ")");
+                    fz.constraint("bool_lin_eq([1, 1, 1, 1], [" + left + ", " + right + ", " + above + ", " +
+                                  below + "], 1)");
+                }
+            }
+        } else if (opt.propagation() == PROP_HALF) {
+            // At least one of the four half-reified relative positions of every pair
+            for (int a = 0; a < n - 1; a++) {
+                for (int b = a + 1; b < n - 1; b++) {
+                    std::string pair = std::to_string(a) + "_" + std::to_string(b);
+                    std::string left = fz.boolVar("left_" + pair);
+                    std::string right = fz.boolVar("right_" + pair);
+                    std::string above = fz.boolVar("above_" + pair);
+                    std::string below = fz.boolVar("below_" + pair);
+                    std::string sa = std::to_string(-sizes[a]), sb = std::to_string(-sizes[b]);
+                    fz.constraint("int_lin_le_imp([1, -1], [" + x[a] + ", " + x[b] + "], " + sa + ", " + left + ")");
+                    fz.constraint("int_lin_le_imp([1, -1], [" + x[b] + ", " + x[a] + "], " + sb + ", " + right + ")");
+                    fz.constraint("int_lin_le_imp([1, -1], [" + y[a] + ", " + y[b] + "], " + sa + ", " + above + ")");
+                    fz.constraint("int_lin_le_imp([1, -1], [" + y[b] + ", " + y[a] + "], " + sb + ", " + below + ")");
+                    fz.constraint("bool_clause([" + left + ", " + right + ", " + above + ", " + below + "], [])");
+                }
+            }
+        } else {
+            // Gecode's FlatZinc no-overlap constraint, the closest to the
+            // propagators of this model that FlatZinc can express. The dual
+            // owner matrix is not written.
+            fz.constraint("gecode_nooverlap(" + FlatZinc::list(x) + ", " + FlatZinc::list(sizes) + ", " +
+                          FlatZinc::list(y) + ", " + FlatZinc::list(sizes) + ")");
+        }
+
+        // The squares covering a column or a row fit into the enclosing square
+        for (int outer = 0; outer < n - 1; outer++) {
+            std::vector<std::string> columns, rows;
+            for (int inner = 0; inner < n - 1; inner++) {
+                std::string name = std::to_string(outer) + "_" + std::to_string(inner);
+                std::string range = std::to_string(outer - sizes[inner] + 1) + ".." + std::to_string(outer);
+                std::string inColumn = fz.boolVar("in_column_" + name);
+                std::string inRow = fz.boolVar("in_row_" + name);
+                fz.constraint("set_in_reif(" + x[inner] + ", " + range + ", " + inColumn + ")");
+                fz.constraint("set_in_reif(" + y[inner] + ", " + range + ", " + inRow + ")");
+                columns.push_back(fz.var("column_" + name, 0, 1));
+                rows.push_back(fz.var("row_" + name, 0, 1));
+                fz.constraint("bool2int(" + inColumn + ", " + columns.back() + ")");
+                fz.constraint("bool2int(" + inRow + ", " + rows.back() + ")");
+            }
+            std::vector<int> coefficients(sizes);
+            coefficients.push_back(-1);
+            columns.push_back(side);
+            rows.push_back(side);
+            fz.constraint("int_lin_le(" + FlatZinc::list(coefficients) + ", " + FlatZinc::list(columns) + ", 0)");
+            fz.constraint("int_lin_le(" + FlatZinc::list(coefficients) + ", " + FlatZinc::list(rows) + ", 0)");
+        }
+
+        // The model selects the coordinate with the largest minimum, which
+        // FlatZinc has no annotation for: smallest is the smallest minimum and
+        // largest the largest maximum. Input order is used instead, which
+        // agrees with the model while the minimums tie, at the root, and
+        // differs below it, so the search order of the export is not the
+        // model's.
+        fz.finish(os, "seq_search([" +
+                      FlatZinc::search(std::vector<std::string>(1, side), "input_order", "indomain_min") + ", " +
+                      FlatZinc::search(x, "input_order", "indomain_min") + ", " +
+                      FlatZinc::search(y, "input_order", "indomain_min") + "])");
+    }
+
+    // Number of squares placed by each work unit
+    int splitDepth(const SquareOptions &opt) const {
+        return std::min(static_cast<int>(opt.splitDepth()), n - 1);
+    }
+
+    // Create the work unit for the placement in this space
+    WorkUnits::Job job(const SquareOptions &opt, int index) const {
+        WorkUnits::Job job;
+        job.n = n;
+        job.side = sizeOfSquare.val();
+        job.id = WorkUnits::identifier(job.side, index);
+        for (int i = 0; i < splitDepth(opt); i++) {
+            job.x.push_back(xCoords[i].val());
+            job.y.push_back(yCoords[i].val());
+        }
+        return job;
+    }
+
+    // Restrict the search to the subproblem of a work unit
+    void restrict(const WorkUnits::Job &job) {
+        rel(*this, sizeOfSquare, IRT_EQ, job.side);
+        for (size_t i = 0; i < job.x.size(); i++) {
+            rel(*this, xCoords[i], IRT_EQ, job.x[i]);
+            rel(*this, yCoords[i], IRT_EQ, job.y[i]);
+        }
+    }
+
+    // Store the placement of a solution in a work unit result
+    void solution(WorkUnits::Result &result) const {
+        for (int i = 0; i < n - 1; i++) {
+            result.x.push_back(xCoords[i].val());
+            result.y.push_back(yCoords[i].val());
+        }
+    }
+
+    // Number of squares
+    int squares() const {
+        return n - 1;
+    }
+
+    // Size of the enclosing square of a solution
+    int side() const {
+        return sizeOfSquare.val();
+    }
+
+    // Coordinates of square i in a solution
+    int x(int i) const {
+        return xCoords[i].val();
+    }
+    int y(int i) const {
+        return yCoords[i].val();
+    }
+
+    // Keep the squares of a solution that are not relaxed in place and
+    // require an enclosing square of at most size bound
+    void relax(const Square &solution, const std::vector<bool> &relaxed, int bound) {
+        rel(*this, sizeOfSquare, IRT_LQ, bound);
+        for (int i = 0; i < n - 1; i++) {
+            if (!relaxed[i]) {
+                rel(*this, xCoords[i], IRT_EQ, solution.x(i));
+                rel(*this, yCoords[i], IRT_EQ, solution.y(i));
+            }
+        }
     }
 
     // Copy constructor
-    Square(bool share, Square &s) : Script(share, s) {
+    Square(bool share, Square &s) : Script(share, s), n(s.n), reified(s.reified), sharedArrays(s.sharedArrays) {
+        sides.update(*this, share, s.sides);
+        owners.update(*this, share, s.owners);
+        corners.update(*this, share, s.corners);
         sizeOfSquare.update(*this, share, s.sizeOfSquare);
         xCoords.update(*this, share, s.xCoords);
         yCoords.update(*this, share, s.yCoords);
     }
 
+    // Count the variables of the space
+    void account(Accounting& a) const {
+        a.vars("IntVar", 1 + xCoords.size() + yCoords.size() + owners.size() + corners.size());
+        a.vars("BoolVar", reified);
+        a.shared(sharedArrays * sides.size() * sizeof(int));
+    }
+
     // Copy method
     virtual Space *copy(bool share) {
+        CloneStats::record(*this);
         return new Square(share, *this);
     }
 
     /// Print solution
     virtual void
     print(std::ostream& os) const {
+        SolutionWriter& writer = SolutionWriter::global();
+        if (writer.active()) {
+            // The side of the enclosing square, then the coordinates
+            std::vector<int> values(1, sizeOfSquare.val());
+            for (int i = 0; i < xCoords.size(); i++)
+                values.push_back(xCoords[i].val());
+            for (int i = 0; i < yCoords.size(); i++)
+                values.push_back(yCoords[i].val());
+            writer.write(values);
+            return;
+        }
         os << "x-coordinates: " << xCoords << std::endl;
         os << "y-coordinates: " << yCoords << std::endl;
         os << "size of enclosing square: " << sizeOfSquare << std::endl;
         os << std::endl;
 
-        int matrix[64][64];
+        std::vector<std::vector<int> > matrix(sizeOfSquare.val(), std::vector<int>(sizeOfSquare.val(), -1));
 
-        for (int row = 0; row < sizeOfSquare.val(); row++) {
-            for (int column = 0; column < sizeOfSquare.val(); column++) {
-                matrix[row][column] = -1;
-            }
-        }
-
-        for (int square = 0; square < N - 1; square++) {
+        for (int square = 0; square < n - 1; square++) {
             for (int row = yCoords[square].val(); row < yCoords[square].val() + size(square); row++) {
                 for (int column = xCoords[square].val(); column < xCoords[square].val() + size(square); column++) {
                     matrix[row][column] = square;
@@ -211,202 +732,331 @@ public:
     }
 };
 
-int main(int argc, char* argv[]) {
-    SizeOptions opt("Square");
-    opt.ipl(IPL_DOM);
-    opt.solutions(1);
-    opt.parse(argc,argv);
-    opt.propagation(Square::PROP_SPECIAL_NO_OVERLAP_PROPAGATOR, "special",
-                    "special no-overlap-propagator");
-    //Comment out the line below to use Gecode's propagator for nooverlap.
-    opt.propagation(Square::PROP_SPECIAL_NO_OVERLAP_PROPAGATOR);
+// Split the search tree into work units and add them to the queue
+void split(const SquareOptions &opt) {
+    WorkUnits::create(opt.queue());
+    Square *root = new Square(opt);
+    DFS<Square> e(root);
+    delete root;
+    int units = 0;
+    while (Square *s = e.next()) {
+        WorkUnits::add(opt.queue(), s->job(opt, units++));
+        delete s;
+    }
+    std::cout << "work units: " << units << std::endl;
+}
+
+// Solve work units from the queue until it is empty
+void work(SquareOptions &opt) {
+    for (;;) {
+        std::vector<std::string> pending = WorkUnits::list(opt.queue(), "pending");
+        if (pending.empty()) {
+            return;
+        }
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (!WorkUnits::claim(opt.queue(), pending[i])) {
+                continue;
+            }
+            WorkUnits::Job job = WorkUnits::read(opt.queue(), pending[i]);
+            WorkUnits::Result result;
+            result.id = job.id;
+            result.side = job.side;
+            result.nodes = result.fails = result.depth = 0;
+            result.time = 0;
+
+            // No need to prove anything above a size already found
+            int best = WorkUnits::bestSide(opt.queue());
+            if (best != -1 && job.side > best) {
+                result.status = WorkUnits::Result::SKIPPED;
+            } else {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                opt.size(job.n);
+                Square *root = new Square(opt);
+                root->restrict(job);
+                DFS<Square> e(root);
+                delete root;
+                Square *s = e.next();
+                Search::Statistics stat = e.statistics();
+                result.status = s != NULL ? WorkUnits::Result::SAT : WorkUnits::Result::UNSAT;
+                if (s != NULL) {
+                    s->solution(result);
+                }
+                delete s;
+                result.nodes = stat.node;
+                result.fails = stat.fail;
+                result.depth = stat.depth;
+                result.time = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+            }
+            WorkUnits::finish(opt.queue(), result);
+            break;
+        }
+    }
+}
 
-    Script::run<Square, DFS, SizeOptions>(opt);
+// Run the requested number of worker processes on the queue
+void workers(SquareOptions &opt) {
+    std::cout.flush();
+    for (unsigned int i = 1; i < opt.workers(); i++) {
+        if (fork() == 0) {
+            work(opt);
+            _exit(0);
+        }
+    }
+    work(opt);
+    while (wait(NULL) > 0) {
+    }
 }
 
-// The no-overlap propagator
+// Combine the results of all work units into the global answer
+void merge(const SquareOptions &opt) {
+    std::vector<WorkUnits::Result> results = WorkUnits::results(opt.queue());
+    std::vector<std::string> pending = WorkUnits::list(opt.queue(), "pending");
+    std::vector<std::string> claimed = WorkUnits::list(opt.queue(), "claimed");
 
-/*
- *  Main author:
- *     Christian Schulte <cschulte@kth.se>
- *
- *  Copyright:
- *     Christian Schulte, 2009
- *
- *  Permission is hereby granted, free of charge, to any person obtaining
- *  a copy of this software and associated documentation files (the
- *  "Software"), to deal in the Software without restriction, including
- *  without limitation the rights to use, copy, modify, merge, publish,
- *  distribute, sublicense, and/or sell copies of the Software, and to
- *  permit persons to whom the Software is furnished to do so, subject to
- *  the following conditions:
- *
- *  The above copyright notice and this permission notice shall be
- *  included in all copies or substantial portions of the Software.
- *
- *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
- *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
- *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
- *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
- *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
- *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
- *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
- *
- */
-
-class NoOverlap : public Propagator {
+    const WorkUnits::Result *best = NULL;
+    unsigned long int nodes = 0, fails = 0, depth = 0;
+    double time = 0;
+    int sat = 0, unsat = 0, skipped = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        const WorkUnits::Result &r = results[i];
+        nodes += r.nodes;
+        fails += r.fails;
+        depth = std::max(depth, r.depth);
+        time += r.time;
+        if (r.status == WorkUnits::Result::SAT) {
+            sat++;
+            if (best == NULL || r.side < best->side) {
+                best = &r;
+            }
+        } else if (r.status == WorkUnits::Result::UNSAT) {
+            unsat++;
+        } else {
+            skipped++;
+        }
+    }
+
+    // The best size is only optimal when no smaller size is left unproven
+    int unfinished = 0;
+    pending.insert(pending.end(), claimed.begin(), claimed.end());
+    for (size_t i = 0; i < pending.size(); i++) {
+        if (best == NULL || WorkUnits::side(pending[i]) < best->side) {
+            unfinished++;
+        }
+    }
+
+    if (best == NULL) {
+        std::cout << (unfinished > 0 ? "no solution found yet" : "no solution") << std::endl;
+    } else {
+        std::cout << (unfinished > 0 ? "best" : "optimal") << " size of enclosing square: "
+                  << best->side << std::endl;
+        std::cout << "x-coordinates: ";
+        for (size_t i = 0; i < best->x.size(); i++) {
+            std::cout << best->x[i] << " ";
+        }
+        std::cout << std::endl << "y-coordinates: ";
+        for (size_t i = 0; i < best->y.size(); i++) {
+            std::cout << best->y[i] << " ";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::endl
+              << "work units:     " << results.size() + pending.size() << std::endl
+              << "\tsat:          " << sat << std::endl
+              << "\tunsat:        " << unsat << std::endl
+              << "\tskipped:      " << skipped << std::endl
+              << "\tunfinished:   " << pending.size() << std::endl
+              << "nodes:          " << nodes << std::endl
+              << "failures:       " << fails << std::endl
+              << "max depth:      " << depth << std::endl
+              << "worker time:    " << time << " ms" << std::endl;
+    if (!claimed.empty()) {
+        std::cout << std::endl
+                  << claimed.size() << " work units are claimed. If no worker is running, "
+                  << "requeue them with -work-units requeue" << std::endl;
+    }
+}
+
+// Return the work units of crashed or killed workers to the queue
+void requeue(const SquareOptions &opt) {
+    std::cout << "requeued work units: " << WorkUnits::requeue(opt.queue()) << std::endl;
+}
+
+// Stops a neighbourhood after a number of failures or at a deadline
+class NeighbourhoodStop : public Search::Stop {
 protected:
-    // The x-coordinates
-    ViewArray<IntView> x;
-    // The width (array)
-    int* w;
-    // The y-coordinates
-    ViewArray<IntView> y;
-    // The heights (array)
-    int* h;
+    unsigned long int fails;
+    std::chrono::steady_clock::time_point deadline;
 public:
-    // Create propagator and initialize
-    NoOverlap(Home home,
-              ViewArray<IntView>& x0, int w0[],
-              ViewArray<IntView>& y0, int h0[])
-            : Propagator(home), x(x0), w(w0), y(y0), h(h0) {
-        x.subscribe(home,*this,PC_INT_BND);
-        y.subscribe(home,*this,PC_INT_BND);
-    }
-    // Post no-overlap propagator
-    static ExecStatus post(Home home,
-                           ViewArray<IntView>& x, int w[],
-                           ViewArray<IntView>& y, int h[]) {
-        // Only if there is something to propagate
-        if (x.size() > 1)
-            (void) new (home) NoOverlap(home,x,w,y,h);
-        return ES_OK;
-    }
-
-    // Copy constructor during cloning
-    NoOverlap(Space& home, bool share, NoOverlap& p)
-            : Propagator(home,share,p) {
-        x.update(home,share,p.x);
-        y.update(home,share,p.y);
-        // Also copy width and height arrays
-        w = home.alloc<int>(x.size());
-        h = home.alloc<int>(y.size());
-        for (int i=x.size(); i--; ) {
-            w[i]=p.w[i]; h[i]=p.h[i];
-        }
-    }
-    // Create copy during cloning
-    virtual Propagator* copy(Space& home, bool share) {
-        return new (home) NoOverlap(home,share,*this);
-    }
-
-    // Re-schedule function after propagator has been re-enabled
-    virtual void reschedule(Space& home) {
-        x.reschedule(home,*this,PC_INT_BND);
-        y.reschedule(home,*this,PC_INT_BND);
-    }
-
-    // Return cost (defined as cheap quadratic)
-    virtual PropCost cost(const Space&, const ModEventDelta&) const {
-        return PropCost::quadratic(PropCost::LO,2*x.size());
-    }
-
-    bool isOverlapping(int a, int u) {
-        bool isAssignedRightOfUnassigned = x[a].min() >= x[u].max() + w[u];
-        bool isAssignedLeftOfUnassigned = x[a].max() + w[a] <= x[u].min();
-        bool isAssignedUnderOfUnassigned = y[a].min() >= y[u].max() + h[u];
-        bool isAssignedOverOfUnassigned = y[a].max() + h[a] <= y[u].min();
-        bool isOverlappingHorizontally = !isAssignedRightOfUnassigned && !isAssignedLeftOfUnassigned;
-        bool isOverlappingVertically = !isAssignedUnderOfUnassigned && !isAssignedOverOfUnassigned;
-        return isOverlappingHorizontally && isOverlappingVertically;
-    }
-
-    // Perform propagation
-    virtual ExecStatus propagate(Space& home, const ModEventDelta&) {
-        bool overlapFound = false;
-
-        for (int a = 0; a < x.size(); a++) {
-            for (int u = a + 1; u < x.size(); u++) {
-                // Check if any squares are overlapping, for reporting subsumption
-                if (isOverlapping(a, u)) {
-                    overlapFound = true;
-                }
+    NeighbourhoodStop(unsigned long int fails0, std::chrono::steady_clock::time_point deadline0)
+            : fails(fails0), deadline(deadline0) {}
+    virtual bool stop(const Search::Statistics &s, const Search::Options &) {
+        return s.fail > fails || std::chrono::steady_clock::now() >= deadline;
+    }
+};
 
-                // When one square is assigned, and one axis of the other square is assigned
-                // values are removed for the unassigned axis
-                if(x[a].assigned() && y[a].assigned()) {
-                    if (y[u].assigned()) {
-                        bool isAssignedUnderOfUnassigned = y[a].val() >= y[u].val() + h[u];
-                        bool isAssignedOverOfUnassigned = y[a].val() + h[a] <= y[u].val();
-                        bool isOverlappingVertically = !isAssignedUnderOfUnassigned && !isAssignedOverOfUnassigned;
-
-                        // If the squares are overlapping vertically, remove all values where
-                        // they are overlapping horizontally
-                        if (isOverlappingVertically) {
-                            for (int i = x[a].val() - w[u] + 1; i < x[a].val() + w[a]; i++) {
-                                GECODE_ME_CHECK(x[u].nq(home, i));
-                            }
-                        }
-                    }
+// Large neighbourhood search: repeatedly relax some squares of the best
+// packing and search for a smaller one, until the time budget is spent
+void lns(const SquareOptions &opt) {
+    typedef std::chrono::steady_clock clock;
+    clock::time_point start = clock::now();
+    clock::time_point deadline = start + std::chrono::milliseconds(opt.lns());
+    std::mt19937 random(opt.lnsSeed());
+    std::ofstream log;
+    if (opt.lnsLog() != NULL) {
+        log.open(opt.lnsLog());
+    }
 
-                    if (x[u].assigned()) {
-                        bool isAssignedRightOfUnassigned = x[a].val() >= x[u].val() + w[u];
-                        bool isAssignedLeftOfUnassigned = x[a].val() + w[a] <= x[u].val();
-                        bool isOverlappingHorizontally = !isAssignedRightOfUnassigned && !isAssignedLeftOfUnassigned;
-                        // If the squares are overlapping horizontally, remove all values where
-                        // they are overlapping vertically
-                        if (isOverlappingHorizontally) {
-                            for (int i = y[a].val() - h[u] + 1; i < y[a].val() + h[a]; i++) {
-                                GECODE_ME_CHECK(y[u].nq(home, i));
-                            }
-                        }
+    Square *root = new Square(opt);
+    if (root->status() == SS_FAILED) {
+        std::cout << "no solution" << std::endl;
+        delete root;
+        return;
+    }
+
+    Square *best = NULL;
+    unsigned long int neighbourhoods = 0;
+    while (clock::now() < deadline) {
+        Square *s = static_cast<Square *>(root->clone());
+        if (best != NULL) {
+            int bound = best->side() - 1;
+            int k = best->squares();
+            std::vector<bool> relaxed(k, false);
+            switch (neighbourhoods++ % 3) {
+                case 0: {
+                    // Random squares
+                    std::uniform_int_distribution<int> percent(0, 99);
+                    for (int i = 0; i < k; i++) {
+                        relaxed[i] = percent(random) < static_cast<int>(opt.lnsRelax());
+                    }
+                    relaxed[std::uniform_int_distribution<int>(0, k - 1)(random)] = true;
+                    break;
+                }
+                case 1: {
+                    // The squares intersecting a random window of half the size
+                    int window = std::max(1, best->side() / 2);
+                    std::uniform_int_distribution<int> corner(0, best->side() - window);
+                    int wx = corner(random), wy = corner(random);
+                    for (int i = 0; i < k; i++) {
+                        relaxed[i] = best->x(i) < wx + window && best->x(i) + s->size(i) > wx &&
+                                     best->y(i) < wy + window && best->y(i) + s->size(i) > wy;
+                    }
+                    break;
+                }
+                default: {
+                    // The squares close to the right or bottom border
+                    int margin = s->size(0);
+                    for (int i = 0; i < k; i++) {
+                        relaxed[i] = best->x(i) + s->size(i) > best->side() - margin ||
+                                     best->y(i) + s->size(i) > best->side() - margin;
                     }
                 }
             }
+            // Squares outside of the tighter bound must always move
+            for (int i = 0; i < k; i++) {
+                if (best->x(i) + s->size(i) > bound || best->y(i) + s->size(i) > bound) {
+                    relaxed[i] = true;
+                }
+            }
+            s->relax(*best, relaxed, bound);
         }
 
-        if (!overlapFound) {
-            return home.ES_SUBSUMED(*this);
+        NeighbourhoodStop stop(best != NULL ? opt.lnsFails() : ~0ul, deadline);
+        Search::Options so;
+        so.stop = &stop;
+        DFS<Square> e(s, so);
+        delete s;
+        if (Square *solution = e.next()) {
+            delete best;
+            best = solution;
+            double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+            std::cout << ms << " ms: size " << best->side() << std::endl;
+            if (log.is_open()) {
+                log << ms << " " << best->side() << std::endl;
+            }
+            if (best->side() == Square::smallestSide(opt.sizes())) {
+                break;
+            }
+        } else if (best == NULL && !e.stopped()) {
+            // The complete search for the first packing failed
+            break;
         }
+    }
 
-        return ES_FIX;
+    std::cout << std::endl << "neighbourhoods: " << neighbourhoods << std::endl;
+    if (best != NULL) {
+        best->print(std::cout);
+    } else {
+        std::cout << "no solution" << std::endl;
     }
+    delete best;
+    delete root;
+}
 
-    // Dispose propagator and return its size
-    virtual size_t dispose(Space& home) {
-        x.cancel(home,*this,PC_INT_BND);
-        y.cancel(home,*this,PC_INT_BND);
-        (void) Propagator::dispose(home);
-        return sizeof(*this);
+int main(int argc, char* argv[]) {
+    SquareOptions opt("Square");
+    opt.ipl(IPL_DOM);
+    opt.solutions(1);
+    opt.size(N);
+    opt.propagation(Square::PROP_DEFAULT, "default",
+                    "reified decomposition of no-overlap");
+    opt.propagation(Square::PROP_SPECIAL_NO_OVERLAP_PROPAGATOR, "special",
+                    "special no-overlap-propagator");
+    opt.propagation(Square::PROP_OCCUPANCY, "occupancy",
+                    "special no-overlap- and occupancy-grid-propagators");
+    opt.propagation(Square::PROP_DUAL, "dual",
+                    "special no-overlap-propagator and the dual owner matrix");
+    opt.propagation(Square::PROP_HALF, "half",
+                    "clause over half-reified decomposition of no-overlap");
+    //Use "-propagation default" to use the decomposition instead of the propagator.
+    opt.propagation(Square::PROP_SPECIAL_NO_OVERLAP_PROPAGATOR);
+    opt.parse(argc,argv);
+    if (opt.flatzinc() != NULL) {
+        std::ofstream fz(opt.flatzinc());
+        Square::flatzinc(fz, opt);
+        return 0;
     }
-};
+    CloneStats::enable(opt.cloneStats());
+    SolutionWriter::global().open(opt.output(), opt.outputFile(), Square::longestSide(opt.sizes()));
+    if (opt.calibrate() > 0)
+        calibrate<Square>(opt);
+    Accounting::start<Square>(opt);
 
-/*
- * Post the constraint that the rectangles defined by the coordinates
- * x and y and width w and height h do not overlap.
- *
- * This is the function that you will call from your model. The best
- * is to paste the entire file into your model.
- */
-void no_overlap(Home home,
-                const IntVarArgs& x, const IntArgs& w,
-                const IntVarArgs& y, const IntArgs& h) {
-    // Check whether the arguments make sense
-    if ((x.size() != y.size()) || (x.size() != w.size()) ||
-        (y.size() != h.size()))
-        throw ArgumentSizeMismatch("nooverlap");
-    // Never post a propagator in a failed space
-    if (home.failed()) return;
-    // Set up array of views for the coordinates
-    ViewArray<IntView> vx(home,x);
-    ViewArray<IntView> vy(home,y);
-    // Set up arrays (allocated in home) for width and height and initialize
-    int* wc = static_cast<Space&>(home).alloc<int>(x.size());
-    int* hc = static_cast<Space&>(home).alloc<int>(y.size());
-    for (int i=x.size(); i--; ) {
-        wc[i]=w[i]; hc[i]=h[i];
-    }
-    // If posting failed, fail space
-    if (NoOverlap::post(home,vx,wc,vy,hc) != ES_OK)
-        home.fail();
-}
\ No newline at end of file
+    switch (opt.workUnits()) {
+        case SquareOptions::WORK_SPLIT:
+            split(opt);
+            break;
+        case SquareOptions::WORK_WORKER:
+            workers(opt);
+            break;
+        case SquareOptions::WORK_MERGE:
+            merge(opt);
+            break;
+        case SquareOptions::WORK_REQUEUE:
+            requeue(opt);
+            break;
+        default:
+            if (opt.lns() > 0) {
+                lns(opt);
+                break;
+            }
+            if (opt.trace() != NULL) {
+                runWithTrace<Square, SquareOptions>(opt);
+            } else if (opt.progress() > 0) {
+                runWithProgress<Square, DFS, SquareOptions>(opt);
+            } else {
+                Script::run<Square, DFS, SquareOptions>(opt);
+            }
+#if defined(NO_OVERLAP_STATS)
+            if (opt.propagation() != Square::PROP_DEFAULT && opt.propagation() != Square::PROP_HALF) {
+                std::cout << "no-overlap stages:" << std::endl
+                          << "\tcheap:         " << NoOverlap::cheapStages << std::endl
+                          << "\texpensive:     " << NoOverlap::expensiveStages << std::endl;
+            }
+#endif
+    }
+    SolutionWriter::global().close();
+    Accounting::finish(opt, "Square");
+    if (opt.cloneStats())
+        CloneStats::print(std::cout);
+}
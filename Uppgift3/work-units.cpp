@@ -0,0 +1,219 @@
+// A file-based job queue for splitting one search into independent work units
+//
+// A queue is a directory with three subdirectories:
+//   pending/  work units waiting for a worker
+//   claimed/  work units a worker is currently solving
+//   done/     the results written by the workers
+//
+// A worker claims a work unit by renaming it from pending/ to claimed/.
+// rename() is atomic within one file system, so any number of worker
+// processes on the same machine can share a queue without locking.
+// Files are always written under a temporary name and renamed into place,
+// so a reader never sees a half-written work unit or result.
+//
+// A worker that crashes or is killed leaves its work unit in claimed/.
+// Once no worker is running, requeue() moves such units back to pending/.
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace WorkUnits {
+
+    // A subproblem: the size of the enclosing square and the placement
+    // of the first x.size() squares
+    struct Job {
+        std::string id;
+        int n;
+        int side;
+        std::vector<int> x;
+        std::vector<int> y;
+    };
+
+    // The outcome of solving a work unit
+    struct Result {
+        enum Status { SAT, UNSAT, SKIPPED };
+        std::string id;
+        Status status;
+        int side;
+        unsigned long int nodes;
+        unsigned long int fails;
+        unsigned long int depth;
+        double time;
+        // The coordinates of all squares, only for SAT results
+        std::vector<int> x;
+        std::vector<int> y;
+    };
+
+    std::string path(const std::string& queue, const char* dir) {
+        return queue + "/" + dir;
+    }
+
+    std::string path(const std::string& queue, const char* dir, const std::string& id) {
+        return queue + "/" + dir + "/" + id;
+    }
+
+    void makeDirectory(const std::string& dir) {
+        if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+            throw std::runtime_error("cannot create directory " + dir);
+    }
+
+    // Create the queue directories, keeping anything already in them
+    void create(const std::string& queue) {
+        makeDirectory(queue);
+        makeDirectory(path(queue, "pending"));
+        makeDirectory(path(queue, "claimed"));
+        makeDirectory(path(queue, "done"));
+    }
+
+    // Sorted names of the entries in subdirectory dir of the queue
+    std::vector<std::string> list(const std::string& queue, const char* dir) {
+        std::vector<std::string> names;
+        DIR* d = opendir(path(queue, dir).c_str());
+        if (d == NULL)
+            return names;
+        while (struct dirent* e = readdir(d)) {
+            if (e->d_name[0] != '.')
+                names.push_back(e->d_name);
+        }
+        closedir(d);
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    // Write content to dir/id of the queue via a temporary file
+    void publish(const std::string& queue, const char* dir,
+                 const std::string& id, const std::string& content) {
+        std::ostringstream tmp;
+        tmp << queue << "/.tmp-" << getpid() << "-" << id;
+        {
+            std::ofstream out(tmp.str().c_str());
+            out << content;
+            if (!out)
+                throw std::runtime_error("cannot write " + tmp.str());
+        }
+        if (rename(tmp.str().c_str(), path(queue, dir, id).c_str()) != 0)
+            throw std::runtime_error("cannot publish " + id);
+    }
+
+    // Identifier ordering work units by the size of the enclosing square,
+    // so that workers prove the small sizes first
+    std::string identifier(int side, int index) {
+        char id[32];
+        std::snprintf(id, sizeof(id), "%05d-%08d", side, index);
+        return id;
+    }
+
+    void add(const std::string& queue, const Job& job) {
+        std::ostringstream os;
+        os << job.n << " " << job.side << " " << job.x.size();
+        for (size_t i = 0; i < job.x.size(); i++)
+            os << " " << job.x[i] << " " << job.y[i];
+        os << std::endl;
+        publish(queue, "pending", job.id, os.str());
+    }
+
+    // Try to claim the work unit id, fails if another worker was faster
+    bool claim(const std::string& queue, const std::string& id) {
+        return rename(path(queue, "pending", id).c_str(),
+                      path(queue, "claimed", id).c_str()) == 0;
+    }
+
+    Job read(const std::string& queue, const std::string& id) {
+        std::ifstream in(path(queue, "claimed", id).c_str());
+        Job job;
+        size_t placed = 0;
+        job.id = id;
+        in >> job.n >> job.side >> placed;
+        job.x.resize(placed);
+        job.y.resize(placed);
+        for (size_t i = 0; i < placed; i++)
+            in >> job.x[i] >> job.y[i];
+        if (!in)
+            throw std::runtime_error("malformed work unit " + id);
+        return job;
+    }
+
+    // Record the result of a claimed work unit and release it
+    void finish(const std::string& queue, const Result& result) {
+        static const char* status[] = { "sat", "unsat", "skipped" };
+        std::ostringstream os;
+        os << status[result.status] << " " << result.side << " "
+           << result.nodes << " " << result.fails << " " << result.depth << " "
+           << result.time << " " << result.x.size();
+        for (size_t i = 0; i < result.x.size(); i++)
+            os << " " << result.x[i] << " " << result.y[i];
+        os << std::endl;
+        publish(queue, "done", result.id, os.str());
+        unlink(path(queue, "claimed", result.id).c_str());
+    }
+
+    // Return the claimed work units to pending/, only safe while no worker
+    // is running. A unit with a result was finished by a worker that died
+    // before releasing it, and is only released. Returns the number of
+    // units returned to pending/.
+    int requeue(const std::string& queue) {
+        int requeued = 0;
+        std::vector<std::string> ids = list(queue, "claimed");
+        for (size_t i = 0; i < ids.size(); i++) {
+            struct stat st;
+            if (stat(path(queue, "done", ids[i]).c_str(), &st) == 0) {
+                unlink(path(queue, "claimed", ids[i]).c_str());
+            } else if (rename(path(queue, "claimed", ids[i]).c_str(),
+                              path(queue, "pending", ids[i]).c_str()) == 0) {
+                requeued++;
+            }
+        }
+        return requeued;
+    }
+
+    std::vector<Result> results(const std::string& queue) {
+        std::vector<Result> results;
+        std::vector<std::string> ids = list(queue, "done");
+        for (size_t i = 0; i < ids.size(); i++) {
+            std::ifstream in(path(queue, "done", ids[i]).c_str());
+            Result r;
+            std::string status;
+            size_t squares = 0;
+            r.id = ids[i];
+            in >> status >> r.side >> r.nodes >> r.fails >> r.depth >> r.time >> squares;
+            r.x.resize(squares);
+            r.y.resize(squares);
+            for (size_t j = 0; j < squares; j++)
+                in >> r.x[j] >> r.y[j];
+            if (!in)
+                continue;
+            r.status = status == "sat" ? Result::SAT :
+                       status == "unsat" ? Result::UNSAT : Result::SKIPPED;
+            results.push_back(r);
+        }
+        return results;
+    }
+
+    // Smallest enclosing square found by any worker so far, or -1
+    int bestSide(const std::string& queue) {
+        int best = -1;
+        std::vector<Result> rs = results(queue);
+        for (size_t i = 0; i < rs.size(); i++) {
+            if (rs[i].status == Result::SAT && (best == -1 || rs[i].side < best))
+                best = rs[i].side;
+        }
+        return best;
+    }
+
+    // Size of the enclosing square encoded in a work unit identifier
+    int side(const std::string& id) {
+        return std::atoi(id.c_str());
+    }
+}
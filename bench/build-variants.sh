@@ -0,0 +1,92 @@
+#!/bin/sh
+# Build the solvers in several profiles and report startup and solve times
+#
+# Usage: bench/build-variants.sh <build root> [variant...]
+#
+# Variants: default, headless, static-lto (headless, static Gecode, LTO)
+# and pgo (static-lto trained on the bundled instances). Startup is the
+# wall time of solving a trivial instance, solve is the sum of the
+# runtimes Gecode reports for the training instances.
+
+ROOT=${1:?usage: $0 <build root> [variant...]}
+shift
+VARIANTS=${*:-default headless static-lto pgo}
+SOURCE=$(cd "$(dirname "$0")/.." && pwd)
+JOBS=$(nproc 2>/dev/null || echo 4)
+
+build() {
+    dir=$1
+    shift
+    for part in Uppgift1 Uppgift3; do
+        # cmake -S/-B and several targets per --target need newer CMake
+        # than the projects' minimum
+        mkdir -p "$dir/$part" &&
+            (cd "$dir/$part" && cmake "$SOURCE/$part" "$@" > /dev/null) ||
+            { echo "configure of $dir/$part failed" >&2; exit 1; }
+        for target in $(targets $part); do
+            cmake --build "$dir/$part" --target "$target" -- -j"$JOBS" > /dev/null ||
+                { echo "build of $target in $dir/$part failed" >&2; exit 1; }
+        done
+    done
+}
+
+targets() {
+    case $1 in
+        Uppgift1) echo sudoku queens ;;
+        Uppgift3) echo square ;;
+    esac
+}
+
+# The bundled instances: all example boards, Queens 8-12 and Square 6-10
+instances() {
+    dir=$1
+    i=0
+    while [ $i -lt 18 ]; do
+        echo "$dir/Uppgift1/sudoku -mode stat -solutions 1 $i"
+        i=$((i + 1))
+    done
+    for n in 8 9 10 11 12; do
+        echo "$dir/Uppgift1/queens -mode stat $n"
+    done
+    for n in 6 7 8 9 10; do
+        echo "$dir/Uppgift3/square -mode stat -propagation special $n"
+    done
+}
+
+now() {
+    date +%s%N
+}
+
+measure() {
+    dir=$1
+    start=$(now)
+    for i in 1 2 3 4 5 6 7 8 9 10; do
+        "$dir/Uppgift1/queens" -mode stat 1 > /dev/null
+    done
+    # Microseconds per run
+    startup=$(( ($(now) - start) / 10000 ))
+    solve=$(instances "$dir" | while read -r command; do
+        $command | awk '/runtime:/ { gsub(/[()]/, ""); print $3 }'
+    done | awk '{ ms += $1 } END { printf "%.3f", ms }')
+    printf "%-12s %14.3f %14s\n" "$variant" "$(echo "$startup" | awk '{ print $1 / 1000 }')" "$solve"
+}
+
+printf "%-12s %14s %14s\n" variant "startup ms" "solve ms"
+for variant in $VARIANTS; do
+    dir=$ROOT/$variant
+    case $variant in
+        default)    build "$dir" ;;
+        headless)   build "$dir" -DHEADLESS=ON ;;
+        static-lto) build "$dir" -DHEADLESS=ON -DGECODE_STATIC=ON -DLTO=ON ;;
+        pgo)
+            flags="-DHEADLESS=ON -DGECODE_STATIC=ON -DLTO=ON -DPGO_DIR=$dir/profiles"
+            build "$dir" $flags -DPGO=GENERATE
+            instances "$dir" | while read -r command; do
+                $command > /dev/null
+            done
+            build "$dir" $flags -DPGO=USE
+            ;;
+        *) echo "unknown variant $variant" >&2; exit 1 ;;
+    esac
+    measure "$dir"
+done
@@ -0,0 +1,67 @@
+#!/bin/sh
+# Solve every instance with the C++ model and through Gecode's FlatZinc
+# runner across thread counts, one JSON object per line
+#
+# Usage: bench/flatzinc-compare.sh <build directory> [fzn-gecode] [threads...]
+#
+# Expects the sudoku and queens binaries in <build directory>/Uppgift1
+# and the square binary in <build directory>/Uppgift3. The search order of
+# the exported Square differs from the model's below the root, see
+# Square::flatzinc, so its Square rows do not compare the same search.
+
+BUILD=${1:?usage: $0 <build directory> [fzn-gecode] [threads...]}
+FZN=${2:-fzn-gecode}
+shift
+[ $# -gt 0 ] && shift
+THREADS=${*:-1 2 4 8}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# The instance matrix: name, binary, size and options of each instance
+instances() {
+    i=0
+    while [ $i -lt 18 ]; do
+        for p in gecode bitset; do
+            echo "sudoku-$i-$p $BUILD/Uppgift1/sudoku $i -solutions 1 -propagation $p"
+        done
+        i=$((i + 1))
+    done
+    for n in 8 9 10 11 12; do
+        echo "queens-$n $BUILD/Uppgift1/queens $n"
+    done
+    for n in 6 7 8 9 10; do
+        for p in default special; do
+            for s in largest full; do
+                echo "square-$n-$p-$s $BUILD/Uppgift3/square $n -propagation $p -symmetry $s"
+                # With the squares 2 and 3 twice, which full symmetry breaking orders
+                echo "square-$n+3,2-$p-$s $BUILD/Uppgift3/square $n -propagation $p -symmetry $s" \
+                     "-sizes $(seq -s , "$n" -1 2),3,2"
+            done
+        done
+    done
+}
+
+# Runtime in ms, nodes and failures from Gecode's statistics
+statistics() {
+    awk '
+        /runtime:/  { line = $0; sub(/.*\(/, "", line); sub(/ ms.*/, "", line); ms = line }
+        /nodes:/    { nodes = $NF }
+        /failures:/ { fails = $NF }
+        END { printf "%s %d %d", ms == "" ? -1 : ms, nodes, fails }'
+}
+
+json() {
+    echo "$4" | {
+        read -r ms nodes fails
+        printf '{"instance":"%s","path":"%s","threads":%d,"ms":%s,"nodes":%d,"failures":%d}\n' \
+               "$1" "$2" "$3" "$ms" "$nodes" "$fails"
+    }
+}
+
+instances | while read -r name binary size options; do
+    "$binary" $options -flatzinc "$WORK/$name.fzn" "$size"
+    for t in $THREADS; do
+        json "$name" cpp "$t" "$("$binary" $options -threads "$t" -mode stat "$size" | statistics)"
+        json "$name" flatzinc "$t" "$("$FZN" -p "$t" -s "$WORK/$name.fzn" | statistics)"
+    done
+done
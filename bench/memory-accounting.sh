@@ -0,0 +1,33 @@
+#!/bin/sh
+# Memory accounting of every model over a range of instances, one JSON
+# object per line, for sizing worker pools by memory
+#
+# Usage: bench/memory-accounting.sh <build directory> [threads]
+#
+# Expects the sudoku and queens binaries in <build directory>/Uppgift1
+# and the square binary in <build directory>/Uppgift3.
+
+BUILD=${1:?usage: $0 <build directory> [threads]}
+THREADS=${2:-1}
+OUT=$(mktemp)
+trap 'rm -f "$OUT"' EXIT
+
+for i in 0 4 8 12 17; do
+    for p in gecode bitset; do
+        "$BUILD/Uppgift1/sudoku" -propagation "$p" -threads "$THREADS" \
+                                 -mode stat -accounting "$OUT" "$i" > /dev/null
+    done
+done
+for n in 8 12 16 20; do
+    for b in cells lines; do
+        "$BUILD/Uppgift1/queens" -branching "$b" -threads "$THREADS" \
+                                 -mode stat -accounting "$OUT" "$n" > /dev/null
+    done
+done
+for n in 6 8 10 12; do
+    for p in default special occupancy; do
+        "$BUILD/Uppgift3/square" -propagation "$p" -threads "$THREADS" \
+                                 -mode stat -accounting "$OUT" "$n" > /dev/null
+    done
+done
+cat "$OUT"
@@ -0,0 +1,26 @@
+#!/bin/sh
+# Invocations of the cheap and expensive no-overlap stages per search node
+#
+# Usage: bench/no-overlap-stages.sh <square binary> [N...]
+#
+# The square binary must be built with -DNO_OVERLAP_STATS=ON.
+
+SQUARE=${1:?usage: $0 <square binary> [N...]}
+shift
+SIZES=${*:-6 7 8 9 10}
+
+printf "%4s %10s %12s %12s %14s\n" N nodes cheap expensive expensive/node
+for n in $SIZES; do
+    "$SQUARE" -propagation special -mode stat "$n" | awk -v n="$n" '
+        /nodes:/     { nodes = $2 }
+        /cheap:/     { cheap = $2 }
+        /expensive:/ { expensive = $2 }
+        END {
+            if (cheap == "") {
+                print "no stage counts, build square with -DNO_OVERLAP_STATS=ON" > "/dev/stderr"
+                exit 1
+            }
+            printf "%4d %10d %12d %12d %14.2f\n", n, nodes, cheap, expensive,
+                   (nodes > 0 ? expensive / nodes : 0)
+        }' || exit 1
+done
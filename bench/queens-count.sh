@@ -0,0 +1,47 @@
+#!/bin/sh
+# Speedup of counting all Queens solutions with parallel DFS, for thread
+# counts from 1 to all cores, checking every count against one thread. The
+# one-thread run always comes first as the baseline, also when the listed
+# thread counts leave it out
+#
+# Usage: bench/queens-count.sh <queens binary> [n] [c-d] [threads...]
+
+QUEENS=${1:?usage: $0 <queens binary> [n] [c-d] [threads...]}
+N=${2:-14}
+CD=${3:-8}
+shift
+[ $# -gt 0 ] && shift
+[ $# -gt 0 ] && shift
+CORES=$(getconf _NPROCESSORS_ONLN)
+THREADS=${*:-$(t=1; while [ $t -lt "$CORES" ]; do echo $t; t=$((t * 2)); done; echo "$CORES")}
+
+# Solutions and runtime in ms
+count() {
+    "$QUEENS" -count -branching lines -c-d "$CD" -threads "$1" "$N" | awk '
+        /solutions:/ { solutions = $2 }
+        /runtime:/   { ms = $2 }
+        END          { print solutions, ms }'
+}
+
+# Print one row against the baseline, flagging a differing count
+row() {
+    mark=""
+    if [ "$2" != "$expected" ]; then
+        mark=" count differs from $expected"
+        status=1
+    fi
+    printf "%8d %12s %10.1f %8.2f%s\n" "$1" "$2" "$3" "$(echo "$base $3" | awk '{ print ($2 > 0 ? $1 / $2 : 0) }')" "$mark"
+}
+
+printf "%8s %12s %10s %8s\n" threads solutions ms speedup
+status=0
+set -- $(count 1)
+expected=$1
+base=$2
+row 1 "$1" "$2"
+for t in $THREADS; do
+    [ "$t" -eq 1 ] && continue
+    set -- $(count "$t")
+    row "$t" "$1" "$2"
+done
+exit $status
@@ -0,0 +1,36 @@
+#!/bin/sh
+# Runtime and peak memory of the bundled models for fixed commit distances
+# and for the distances chosen by -calibrate
+#
+# Usage: bench/recomputation.sh <build directory> [probe dives]
+#
+# Expects the sudoku and queens binaries in <build directory>/Uppgift1
+# and the square binary in <build directory>/Uppgift3.
+
+BUILD=${1:?usage: $0 <build directory> [probe dives]}
+PROBES=${2:-20}
+
+# run <size> <command...>
+run() {
+    size=$1
+    shift
+    "$@" -mode stat "$size" | awk '
+        /choice:/       { choice = $3 "/" $5 }
+        /runtime:/      { gsub(/[()]/, ""); ms = $3 }
+        /peak memory:/  { memory = $3 }
+        /nodes:/        { nodes = $2 }
+        END { printf "%-8s %10.3f %10d %10d", choice, ms, memory, nodes }'
+}
+
+printf "%-16s %-12s %-8s %10s %10s %10s\n" model distances choice ms "memory KB" nodes
+for model in "sudoku 5:$BUILD/Uppgift1/sudoku -propagation bitset" \
+             "queens 12:$BUILD/Uppgift1/queens -solutions 0" \
+             "square 8:$BUILD/Uppgift3/square -propagation special"; do
+    name=${model%%:*}
+    size=${name#* }
+    command=${model#*:}
+    for cd in 1 4 8 16 32; do
+        printf "%-16s %-12s %s\n" "$name" "-c-d $cd" "$(run $size $command -c-d $cd -a-d $((cd / 4 + 1)))"
+    done
+    printf "%-16s %-12s %s\n" "$name" calibrated "$(run $size $command -calibrate $PROBES)"
+done
@@ -0,0 +1,31 @@
+#!/bin/sh
+# Wall time and output size of enumerating all Queens solutions with the
+# text, compact and binary solution formats
+#
+# Usage: bench/solution-output.sh <queens binary> [n]
+#
+# Text output goes to a file through stdout, compact and binary through
+# -output-file, so that all three pay for writing the same solutions.
+
+QUEENS=${1:?usage: $0 <queens binary> [n]}
+N=${2:-12}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+now() {
+    date +%s%N
+}
+
+printf "%-8s %10s %12s\n" format "wall ms" bytes
+for format in text compact binary; do
+    start=$(now)
+    if [ "$format" = text ]; then
+        "$QUEENS" -solutions 0 -branching lines "$N" > "$WORK/$format"
+    else
+        "$QUEENS" -solutions 0 -branching lines -output "$format" \
+                  -output-file "$WORK/$format" "$N" > /dev/null
+    fi
+    end=$(now)
+    printf "%-8s %10d %12d\n" "$format" $(((end - start) / 1000000)) \
+           "$(wc -c < "$WORK/$format")"
+done
@@ -0,0 +1,36 @@
+#!/bin/sh
+# Variables, clone size, nodes and runtime of Square with the reified
+# decomposition, the half-reified decomposition and the no-overlap
+# propagator, for N up to 20
+#
+# Usage: bench/square-decompositions.sh <square binary> [time limit in ms] [N...]
+#
+# Runs hitting the time limit are marked with a *.
+
+SQUARE=${1:?usage: $0 <square binary> [time limit in ms] [N...]}
+LIMIT=${2:-60000}
+shift
+[ $# -gt 0 ] && shift
+SIZES=${*:-$(seq 6 20)}
+ACCOUNTING=$(mktemp)
+trap 'rm -f "$ACCOUNTING"' EXIT
+
+printf "%4s %10s %8s %8s %12s %12s %10s\n" \
+       N propagation IntVars BoolVars "root bytes" "clone bytes" ms
+for n in $SIZES; do
+    for p in default half special; do
+        : > "$ACCOUNTING"
+        stat=$("$SQUARE" -propagation "$p" -mode stat -time "$LIMIT" \
+                         -accounting "$ACCOUNTING" "$n" | awk '
+            /runtime:/ { line = $0; sub(/.*\(/, "", line); sub(/ ms.*/, "", line); ms = line }
+            /stopped/  { stopped = "*" }
+            END        { printf "%s%s", ms, stopped }')
+        awk -v n="$n" -v p="$p" -v stat="$stat" '
+            function field(name,    s) {
+                if (!match($0, "\"" name "\":[0-9]+")) return 0
+                s = substr($0, RSTART, RLENGTH); sub(/.*:/, "", s); return s
+            }
+            { printf "%4d %10s %8d %8d %12d %12d %10s\n", n, p, field("IntVar"), field("BoolVar"),
+                     field("root_bytes"), field("clone_bytes_average"), stat }' "$ACCOUNTING"
+    done
+done
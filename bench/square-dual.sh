@@ -0,0 +1,33 @@
+#!/bin/sh
+# Nodes, runtime and memory of Square with the reified decomposition, the
+# no-overlap propagator and the dual owner matrix
+#
+# Usage: bench/square-dual.sh <square binary> [time limit in ms] [N...]
+#
+# Memory is the root space and the peak bytes per clone times the peak
+# number of live spaces, from -accounting.
+
+SQUARE=${1:?usage: $0 <square binary> [time limit in ms] [N...]}
+LIMIT=${2:-60000}
+shift
+[ $# -gt 0 ] && shift
+SIZES=${*:-6 7 8 9 10}
+ACCOUNTING=$(mktemp)
+trap 'rm -f "$ACCOUNTING" "$ACCOUNTING.stat"' EXIT
+
+printf "%4s %10s %10s %10s %12s %14s\n" N propagation nodes ms "root bytes" "search bytes"
+for n in $SIZES; do
+    for p in default special dual; do
+        : > "$ACCOUNTING"
+        "$SQUARE" -propagation "$p" -mode stat -time "$LIMIT" \
+                  -accounting "$ACCOUNTING" "$n" | awk '
+            /runtime:/ { line = $0; sub(/.*\(/, "", line); sub(/ ms.*/, "", line); ms = line }
+            /nodes:/   { nodes = $2 }
+            /stopped/  { stopped = "*" }
+            END        { printf "%d%s %s\n", nodes, stopped, ms }' > "$ACCOUNTING.stat"
+        read -r nodes ms < "$ACCOUNTING.stat"
+        memory=$(sed -e 's/.*"root_bytes":\([0-9]*\).*"clone_bytes_peak":\([0-9]*\),"peak_live_spaces":\([0-9]*\).*/\1 \2 \3/' "$ACCOUNTING")
+        echo "$n $p $nodes $ms $memory" | awk '
+            { printf "%4d %10s %10s %10s %12d %14d\n", $1, $2, $3, $4, $5, $6 * $7 }'
+    done
+done
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Nodes explored with the largest-square restriction only and with full
+# symmetry breaking, for N from 6 to 20
+#
+# Usage: bench/square-symmetry.sh <square binary> [time limit in ms] [N...]
+#
+# Every N is run on the squares N, ..., 2 and on a variant with the
+# squares 2 and 3 twice, which has interchangeable squares to order.
+# Runs hitting the time limit are marked with a *.
+
+SQUARE=${1:?usage: $0 <square binary> [time limit in ms] [N...]}
+LIMIT=${2:-60000}
+shift
+[ $# -gt 0 ] && shift
+SIZES=${*:-$(seq 6 20)}
+
+# Nodes and whether the search was stopped
+nodes() {
+    "$SQUARE" -propagation special -mode stat -time "$LIMIT" "$@" | awk '
+        /nodes:/   { nodes = $2 }
+        /stopped/  { stopped = "*" }
+        END        { printf "%d%s", nodes, stopped }'
+}
+
+row() {
+    largest=$(nodes -symmetry largest "$@")
+    full=$(nodes -symmetry full "$@")
+    printf "%10s %14s %14s %10s\n" "$instance" "$largest" "$full" "$(
+        echo "${largest%\*} ${full%\*}" |
+            awk '{ printf "%.1f%%", ($1 > 0 ? 100 * (1 - $2 / $1) : 0) }')"
+}
+
+printf "%10s %14s %14s %10s\n" instance "largest nodes" "full nodes" reduction
+for n in $SIZES; do
+    instance=$n
+    row "$n"
+    sizes=$(seq -s , "$n" -1 2),3,2
+    instance=$n+3,2
+    row -sizes "$sizes" "$n"
+done
@@ -0,0 +1,33 @@
+#!/bin/sh
+# Mean and maximum latency per puzzle with Gecode's domain consistent
+# distinct, with the bitset propagator and with adaptive propagation, and
+# the levels that solved the puzzles adaptively
+#
+# Usage: bench/sudoku-adaptive.sh <sudoku binary> [puzzle database] [fail limit]
+
+SUDOKU=${1:?usage: $0 <sudoku binary> [puzzle database] [fail limit]}
+DATABASE=$2
+FAILS=${3:-10}
+
+run() {
+    if [ -n "$DATABASE" ]; then
+        "$SUDOKU" -solutions 1 -puzzles "$DATABASE" "$@" 0
+    else
+        "$SUDOKU" -solutions 1 "$@" 0
+    fi
+}
+
+# Latencies of the rows of a batch and the levels that solved them
+latencies() {
+    awk '/^ *[0-9]+ / && NF >= 5  { n++; sum += $5; if ($5 > max) max = $5 }
+         /^\t\t/                  { levels = levels " " $1 $2 }
+         END { printf "%10.3f %10.3f %s\n", n ? sum / n : 0, max, levels }'
+}
+
+printf "%-10s %10s %10s %s\n" mode "mean ms" "max ms" "solved at"
+for p in gecode bitset; do
+    printf "%-10s " "$p"
+    run -ipl dom -propagation "$p" -batch | latencies
+done
+printf "%-10s " adaptive
+run -adaptive -adaptive-fails "$FAILS" -batch | latencies
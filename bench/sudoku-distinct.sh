@@ -0,0 +1,29 @@
+#!/bin/sh
+# Compare Gecode's distinct (-ipl val and dom) with the bitset all-different
+# propagator on all example Sudoku puzzles
+#
+# Usage: bench/sudoku-distinct.sh <sudoku binary> [number of examples]
+
+SUDOKU=${1:?usage: $0 <sudoku binary> [number of examples]}
+EXAMPLES=${2:-18}
+
+stat() {
+    "$SUDOKU" -mode stat "$@" | awk '
+        /runtime:/      { gsub(/[()]/, ""); ms = $3 }
+        /nodes:/        { nodes = $2 }
+        /failures:/     { fails = $2 }
+        /propagations:/ { props = $2 }
+        END { printf "%10.3f %8d %8d %12d", ms, nodes, fails, props }'
+}
+
+printf "%7s %-8s %10s %8s %8s %12s\n" puzzle variant ms nodes failures propagations
+i=0
+while [ $i -lt "$EXAMPLES" ]; do
+    for variant in "val:-propagation gecode -ipl val" \
+                   "dom:-propagation gecode -ipl dom" \
+                   "bitset:-propagation bitset"; do
+        name=${variant%%:*}
+        printf "%7d %-8s %s\n" $i "$name" "$(stat ${variant#*:} $i)"
+    done
+    i=$((i + 1))
+done
@@ -0,0 +1,26 @@
+#!/bin/sh
+# Nodes and failures per example puzzle, solved as one batch with and
+# without carrying the afc of each cell over to the next puzzle
+#
+# Usage: bench/sudoku-warm-start.sh <sudoku binary> [branching] [decay]
+#
+# Both batches branch on the same merit, the warm one with the counts
+# carried over and decayed by decay per puzzle, the cold one with zeros.
+
+SUDOKU=${1:?usage: $0 <sudoku binary> [branching] [decay]}
+BRANCHING=${2:-sizeafc}
+DECAY=${3:-0.9}
+
+batch() {
+    "$SUDOKU" "$@" -batch -branching "$BRANCHING" -decay "$DECAY" 0 |
+        awk '/^ *[0-9]+ / { print $1, $3, $4 }'
+}
+
+batch > /tmp/sudoku-cold.$$
+batch -warm > /tmp/sudoku-warm.$$
+printf "%6s %10s %10s %10s %10s\n" puzzle "cold nodes" "warm nodes" "cold fails" "warm fails"
+paste -d " " /tmp/sudoku-cold.$$ /tmp/sudoku-warm.$$ | awk '
+    { printf "%6d %10d %10d %10d %10d\n", $1, $2, $5, $3, $6
+      cn += $2; wn += $5; cf += $3; wf += $6 }
+    END { printf "%6s %10d %10d %10d %10d\n", "total", cn, wn, cf, wf }'
+rm -f /tmp/sudoku-cold.$$ /tmp/sudoku-warm.$$
@@ -0,0 +1,167 @@
+// Memory accounting of the spaces of a model
+//
+// With -accounting <file> the drivers append one JSON object per run to
+// file: the variables of the root space by type, its propagators and
+// branchers by kind with the heap memory they hold, the bytes of the root
+// space after the initial propagation, the average and peak bytes per
+// clone, the heap memory shared by all clones, and the peak number of
+// spaces alive at the same time during search. The peak live spaces times
+// the peak bytes per clone, plus the shared memory, bounds the memory of
+// the search.
+//
+// Memory shared by all clones, such as the sizes of the propagators, is
+// neither copied by a clone nor reported by allocated(). Models report it
+// once in account(), with their variables, and hold an Accounting::Live
+// member, which counts the spaces alive once start() enabled accounting,
+// and touches nothing shared otherwise.
+
+#ifndef ACCOUNTING_HH
+#define ACCOUNTING_HH
+
+#include <gecode/kernel.hh>
+
+#include <cxxabi.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeinfo>
+
+#include "clone-stats.hh"
+
+class Accounting {
+public:
+    // Counts the spaces alive, as a member of the model
+    class Live {
+    protected:
+        // Whether the space was counted, so that it is uncounted once
+        bool counted;
+    public:
+        Live() : counted(on()) { if (counted) add(1); }
+        Live(const Live&) : counted(on()) { if (counted) add(1); }
+        ~Live() { if (counted) add(-1); }
+    };
+
+    // Number and heap bytes of the actors of one kind
+    struct Actors {
+        unsigned long int count;
+        unsigned long int heap;
+        Actors() : count(0), heap(0) {}
+    };
+
+protected:
+    std::map<std::string, unsigned long int> variables;
+    std::map<std::string, Actors> propagators, branchers;
+    unsigned long int rootBytes;
+    unsigned long int sharedBytes;
+    bool rootFailed;
+
+    // Set by start() before the search creates any spaces
+    std::atomic<bool> enabled;
+    std::atomic<long int> live, peak;
+
+    Accounting() : rootBytes(0), sharedBytes(0), rootFailed(false), enabled(false), live(0), peak(0) {}
+
+    static Accounting& global() {
+        static Accounting accounting;
+        return accounting;
+    }
+
+    static bool on() {
+        return global().enabled.load(std::memory_order_relaxed);
+    }
+
+    static void add(long int d) {
+        Accounting& g = global();
+        long int l = g.live.fetch_add(d, std::memory_order_relaxed) + d;
+        long int p = g.peak.load(std::memory_order_relaxed);
+        while (l > p && !g.peak.compare_exchange_weak(p, l, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Readable name of the dynamic type of an actor
+    static std::string kind(const Gecode::Actor& a) {
+        int status;
+        char* name = abi::__cxa_demangle(typeid(a).name(), NULL, NULL, &status);
+        std::string s = status == 0 ? name : typeid(a).name();
+        std::free(name);
+        return s;
+    }
+
+    static void json(std::ostream& os, const std::map<std::string, Actors>& m) {
+        os << "{";
+        for (std::map<std::string, Actors>::const_iterator i = m.begin(); i != m.end(); ++i)
+            os << (i == m.begin() ? "" : ",") << "\"" << i->first << "\":{\"count\":"
+               << i->second.count << ",\"heap\":" << i->second.heap << "}";
+        os << "}";
+    }
+
+public:
+    // Count n variables of type, called from the models' account()
+    void vars(const char* type, unsigned long int n) {
+        variables[type] += n;
+    }
+
+    // Count heap memory shared by all clones, called from account()
+    void shared(unsigned long int bytes) {
+        sharedBytes += bytes;
+    }
+
+    // Account the root space of the instance of opt, before searching it
+    template<class Model, class Options>
+    static void start(const Options& opt) {
+        if (opt.accounting() == NULL)
+            return;
+        Accounting& g = global();
+        std::unique_ptr<Model> root(new Model(opt));
+        g.rootFailed = root->status() == Gecode::SS_FAILED;
+        g.rootBytes = root->allocated();
+        root->account(g);
+        if (!g.rootFailed) {
+            for (Gecode::Space::Propagators p(*root); p(); ++p) {
+                Actors& a = g.propagators[kind(p.propagator())];
+                a.count++;
+                a.heap += p.propagator().allocated();
+            }
+            for (Gecode::Space::Branchers b(*root); b(); ++b) {
+                Actors& a = g.branchers[kind(b.brancher())];
+                a.count++;
+                a.heap += b.brancher().allocated();
+            }
+        }
+        root.reset();
+        g.enabled = true;
+        CloneStats::enable(true);
+    }
+
+    // Append the accounting of the run to the file of opt
+    template<class Options>
+    static void finish(const Options& opt, const char* model) {
+        if (opt.accounting() == NULL)
+            return;
+        Accounting& g = global();
+        std::ofstream os(opt.accounting(), std::ios::app);
+        os << "{\"model\":\"" << model << "\",\"size\":" << opt.size()
+           << ",\"variables\":{";
+        for (std::map<std::string, unsigned long int>::const_iterator i = g.variables.begin();
+             i != g.variables.end(); ++i)
+            os << (i == g.variables.begin() ? "" : ",") << "\"" << i->first << "\":" << i->second;
+        os << "},\"propagators\":";
+        json(os, g.propagators);
+        os << ",\"branchers\":";
+        json(os, g.branchers);
+        os << ",\"root_failed\":" << (g.rootFailed ? "true" : "false")
+           << ",\"root_bytes\":" << g.rootBytes
+           << ",\"shared_bytes\":" << g.sharedBytes
+           << ",\"clones\":" << CloneStats::clones()
+           << ",\"clone_bytes_average\":" << CloneStats::average()
+           << ",\"clone_bytes_peak\":" << CloneStats::peak()
+           << ",\"peak_live_spaces\":" << g.peak
+           << "}" << std::endl;
+    }
+};
+
+#endif
@@ -0,0 +1,75 @@
+// Bytes copied per clone
+//
+// Models call CloneStats::record() from their copy() function. When
+// enabled, the memory of the space being copied is added to the
+// statistics: the clone copies the live part of that memory, so this is
+// a close upper bound for the bytes copied by the clone.
+
+#ifndef CLONE_STATS_HH
+#define CLONE_STATS_HH
+
+#include <gecode/kernel.hh>
+
+#include <atomic>
+#include <ostream>
+
+class CloneStats {
+protected:
+    std::atomic<bool> enabled;
+    std::atomic<unsigned long int> clones, bytes, peak;
+
+    CloneStats() : enabled(false), clones(0), bytes(0), peak(0) {}
+
+    static CloneStats& global() {
+        static CloneStats stats;
+        return stats;
+    }
+public:
+    static void enable(bool on) {
+        global().enabled = on;
+    }
+
+    static bool active() {
+        return global().enabled;
+    }
+
+    // Record that space s is being copied
+    static void record(const Gecode::Space& s) {
+        CloneStats& g = global();
+        if (!g.enabled.load(std::memory_order_relaxed))
+            return;
+        unsigned long int b = s.allocated();
+        g.clones.fetch_add(1, std::memory_order_relaxed);
+        g.bytes.fetch_add(b, std::memory_order_relaxed);
+        unsigned long int p = g.peak.load(std::memory_order_relaxed);
+        while (b > p && !g.peak.compare_exchange_weak(p, b, std::memory_order_relaxed)) {
+        }
+    }
+
+    static unsigned long int clones() {
+        return global().clones;
+    }
+
+    static unsigned long int average() {
+        CloneStats& g = global();
+        unsigned long int n = g.clones;
+        return n > 0 ? g.bytes / n : 0;
+    }
+
+    static unsigned long int peak() {
+        return global().peak;
+    }
+
+    static void print(std::ostream& os) {
+        CloneStats& g = global();
+        if (!g.enabled)
+            return;
+        unsigned long int n = g.clones;
+        os << "clones:" << std::endl
+           << "\tcopies:       " << n << std::endl
+           << "\taverage:      " << (n > 0 ? g.bytes / n : 0) << " bytes" << std::endl
+           << "\tpeak:         " << g.peak << " bytes" << std::endl;
+    }
+};
+
+#endif
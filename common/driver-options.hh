@@ -0,0 +1,76 @@
+// Options shared by all drivers
+//
+// Extends Gecode's SizeOptions with the instrumentation used to profile
+// long searches. Every driver parses these options, a model specific
+// options class can derive from DriverOptions to add its own.
+
+#ifndef DRIVER_OPTIONS_HH
+#define DRIVER_OPTIONS_HH
+
+#include <gecode/driver.hh>
+
+#include "solution-writer.hh"
+
+class DriverOptions : public Gecode::SizeOptions {
+protected:
+    // Interval between progress reports in milliseconds, 0 for none
+    Gecode::Driver::UnsignedIntOption _progress;
+    // File for progress reports as JSON lines, stderr if not given
+    Gecode::Driver::StringValueOption _progressFile;
+    // Whether to report the bytes copied per clone
+    Gecode::Driver::BoolOption _cloneStats;
+    // Number of probe dives to calibrate the recomputation distances, 0 for none
+    Gecode::Driver::UnsignedIntOption _calibrate;
+    // File to write the model of the instance to as FlatZinc, instead of solving
+    Gecode::Driver::StringValueOption _flatzinc;
+    // Format of the solutions, see solution-writer.hh
+    Gecode::Driver::StringOption _output;
+    // File for compact or binary solutions, stdout if not given
+    Gecode::Driver::StringValueOption _outputFile;
+    // File to append the memory accounting of the run to, see accounting.hh
+    Gecode::Driver::StringValueOption _accounting;
+    // File to trace the search tree to, see trace.hh
+    Gecode::Driver::StringValueOption _trace;
+    // Write every k-th node of the trace
+    Gecode::Driver::UnsignedIntOption _traceSample;
+public:
+    DriverOptions(const char* s)
+            : Gecode::SizeOptions(s),
+              _progress("progress", "interval between progress reports in ms (0 for none)", 0),
+              _progressFile("progress-file", "write progress reports as JSON lines to file", NULL),
+              _cloneStats("clone-stats", "report average and peak bytes copied per clone", false),
+              _calibrate("calibrate", "probe dives to choose -c-d and -a-d (0 for none)", 0),
+              _flatzinc("flatzinc", "write the instance as FlatZinc to file and exit", NULL),
+              _output("output", "format of the solutions", SolutionWriter::TEXT),
+              _outputFile("output-file", "write compact or binary solutions to file", NULL),
+              _accounting("accounting", "append variables, propagators and memory per space as JSON to file", NULL),
+              _trace("trace", "trace the search tree to file (see tracesum)", NULL),
+              _traceSample("trace-sample", "write every k-th node of the trace", 1) {
+        add(_progress);
+        add(_progressFile);
+        add(_cloneStats);
+        add(_calibrate);
+        add(_flatzinc);
+        _output.add(SolutionWriter::TEXT, "text", "print the solutions");
+        _output.add(SolutionWriter::COMPACT, "compact", "one buffered line per solution");
+        _output.add(SolutionWriter::BINARY, "binary", "buffered packed binary records, needs -output-file");
+        add(_output);
+        add(_outputFile);
+        add(_accounting);
+        add(_trace);
+        add(_traceSample);
+    }
+
+    unsigned int progress() const { return _progress.value(); }
+    const char* progressFile() const { return _progressFile.value(); }
+    bool cloneStats() const { return _cloneStats.value(); }
+    unsigned int calibrate() const { return _calibrate.value(); }
+    const char* flatzinc() const { return _flatzinc.value(); }
+    int output() const { return _output.value(); }
+    const char* outputFile() const { return _outputFile.value(); }
+    const char* accounting() const { return _accounting.value(); }
+    const char* trace() const { return _trace.value(); }
+    unsigned int traceSample() const { return _traceSample.value(); }
+};
+
+#endif
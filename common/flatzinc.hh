@@ -0,0 +1,73 @@
+// Writing models as FlatZinc
+//
+// FlatZinc wants all variables declared before the first constraint, so
+// the writer collects declarations and constraints separately and writes
+// them out together with the solve item in finish().
+
+#ifndef FLATZINC_HH
+#define FLATZINC_HH
+
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class FlatZinc {
+protected:
+    std::ostringstream variables;
+    std::ostringstream constraints;
+public:
+    // FlatZinc array literal of the elements of v
+    template<class T>
+    static std::string list(const std::vector<T>& v) {
+        std::ostringstream os;
+        os << "[";
+        for (size_t i = 0; i < v.size(); i++)
+            os << (i > 0 ? ", " : "") << v[i];
+        os << "]";
+        return os.str();
+    }
+
+    // Declare an integer variable and return its name
+    std::string var(const std::string& name, int min, int max, bool output = false) {
+        variables << "var " << min << ".." << max << ": " << name;
+        if (output)
+            variables << " :: output_var";
+        variables << ";" << std::endl;
+        return name;
+    }
+
+    // Declare a Boolean variable and return its name
+    std::string boolVar(const std::string& name) {
+        variables << "var bool: " << name << ";" << std::endl;
+        return name;
+    }
+
+    // Declare an array of integer variables shown in the output
+    void output(const std::string& name, const std::vector<std::string>& vars) {
+        variables << "array [1.." << vars.size() << "] of var int: " << name
+                  << " :: output_array([1.." << vars.size() << "]) = " << list(vars) << ";" << std::endl;
+    }
+
+    // Post a constraint, with an optional annotation such as domain
+    void constraint(const std::string& c, const std::string& annotation = "") {
+        constraints << "constraint " << c;
+        if (!annotation.empty())
+            constraints << " :: " << annotation;
+        constraints << ";" << std::endl;
+    }
+
+    // Write the model with the given search annotation for a satisfaction problem
+    void finish(std::ostream& os, const std::string& search) {
+        os << variables.str() << constraints.str()
+           << "solve :: " << search << " satisfy;" << std::endl;
+    }
+
+    // Search annotation for vars
+    static std::string search(const std::vector<std::string>& vars,
+                              const char* var, const char* val) {
+        return std::string("int_search(") + list(vars) + ", " + var + ", " + val + ", complete)";
+    }
+};
+
+#endif
@@ -0,0 +1,93 @@
+# Build profiles shared by the assignments
+#
+#   HEADLESS       link no Gist or Qt. Gecode must be configured without Gist.
+#   GECODE_STATIC  link the static Gecode libraries (libgecode*.a)
+#   LTO            link time optimization
+#   PGO            GENERATE to build instrumented binaries that write
+#                  profiles to PGO_DIR, USE to optimize with those profiles
+#
+# Every target links only the Gecode modules it uses, see gecode_link(),
+# and the tools that only read and write files link none.
+#
+# bench/build-variants.sh builds the variants, trains the PGO build on the
+# bundled instances and reports startup and solve times.
+
+if(NOT CMAKE_BUILD_TYPE)
+    set(CMAKE_BUILD_TYPE Release CACHE STRING "Build type" FORCE)
+endif()
+
+option(HEADLESS "Link without Gist and Qt" OFF)
+option(GECODE_STATIC "Link the static Gecode libraries" OFF)
+option(LTO "Build with link time optimization" OFF)
+set(PGO "" CACHE STRING "Profile guided optimization: GENERATE, USE or empty")
+set(PGO_DIR ${CMAKE_BINARY_DIR}/pgo CACHE PATH "Directory of the PGO profiles")
+
+set(GECODE_DIR ${CMAKE_CURRENT_SOURCE_DIR}/../../gecode-5.0.0)
+include_directories(${GECODE_DIR})
+include_directories(${CMAKE_CURRENT_SOURCE_DIR}/../common)
+
+# The progress reports and the solver service run on their own threads
+find_package(Threads REQUIRED)
+
+if(GECODE_STATIC)
+    set(GECODE_SUFFIX .a)
+else()
+    set(GECODE_SUFFIX .so)
+endif()
+
+# The modules in dependency order, so that static linking resolves every
+# symbol, and the modules each of them needs
+set(GECODE_MODULES driver gist minimodel set float int search kernel support)
+set(GECODE_NEEDS_driver gist minimodel set float int search kernel support)
+set(GECODE_NEEDS_gist search int kernel support)
+set(GECODE_NEEDS_minimodel set float int search kernel support)
+set(GECODE_NEEDS_set int kernel support)
+set(GECODE_NEEDS_float int kernel support)
+set(GECODE_NEEDS_int kernel support)
+set(GECODE_NEEDS_search kernel support)
+set(GECODE_NEEDS_kernel support)
+
+# Link target with the Gecode modules it uses directly. A shared library
+# brings the modules it needs itself, static ones are added here. Gist is
+# never linked HEADLESS, and brings Qt otherwise.
+function(gecode_link target)
+    set(needed ${ARGN})
+    if(GECODE_STATIC)
+        foreach(module ${ARGN})
+            list(APPEND needed ${GECODE_NEEDS_${module}})
+        endforeach()
+    endif()
+    if(HEADLESS)
+        list(REMOVE_ITEM needed gist)
+    endif()
+    set(libraries)
+    foreach(module ${GECODE_MODULES})
+        list(FIND needed ${module} index)
+        if(NOT index EQUAL -1)
+            list(APPEND libraries ${GECODE_DIR}/libgecode${module}${GECODE_SUFFIX})
+        endif()
+    endforeach()
+    list(FIND needed gist index)
+    if(NOT index EQUAL -1)
+        # sudo apt-get install libqt4-dev
+        find_package(Qt4 REQUIRED QtGui)
+        list(APPEND libraries Qt4::QtGui)
+    endif()
+    target_link_libraries(${target} ${libraries} Threads::Threads)
+endfunction()
+
+# Optimization flags of the profile for target
+function(gecode_profile target)
+    if(LTO)
+        target_compile_options(${target} PRIVATE -flto)
+        set_property(TARGET ${target} APPEND_STRING PROPERTY LINK_FLAGS " -flto")
+    endif()
+    if(PGO STREQUAL "GENERATE")
+        target_compile_options(${target} PRIVATE -fprofile-generate=${PGO_DIR})
+        set_property(TARGET ${target} APPEND_STRING PROPERTY LINK_FLAGS " -fprofile-generate=${PGO_DIR}")
+    elseif(PGO STREQUAL "USE")
+        target_compile_options(${target} PRIVATE -fprofile-use=${PGO_DIR} -fprofile-correction -Wno-missing-profile)
+    elseif(NOT PGO STREQUAL "")
+        message(FATAL_ERROR "PGO must be GENERATE, USE or empty")
+    endif()
+endfunction()
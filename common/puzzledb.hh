@@ -0,0 +1,134 @@
+// Memory-mapped database of Sudoku puzzles
+//
+// File layout, integers in host byte order (little endian on x86):
+//   header   magic "SUDOKUDB", uint32 version, uint32 cells per puzzle,
+//            uint64 number of puzzles, uint64 offset of the offset table
+//   table    uint64 file offset of each puzzle
+//   puzzles  the cells packed at 4 bits, cell 2k in the low nibble of
+//            byte k and cell 2k+1 in the high nibble, 0 for empty
+//
+// The file is mapped read-only, so opening it costs the same for any
+// number of puzzles, a puzzle is read by a single table lookup, and all
+// processes reading the same database share its pages in the page cache.
+
+#ifndef PUZZLEDB_HH
+#define PUZZLEDB_HH
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The example puzzles, which the build writes next to the binaries
+#ifndef EXAMPLES_DB
+#define EXAMPLES_DB "examples.db"
+#endif
+
+class PuzzleDB {
+public:
+    static const int CELLS = 81;
+    // Bytes per packed puzzle
+    static const int RECORD = (CELLS + 1) / 2;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t cells;
+        uint64_t count;
+        uint64_t table;
+    };
+
+protected:
+    const unsigned char* data;
+    size_t length;
+    const Header* header;
+    const uint64_t* offsets;
+
+    PuzzleDB(const PuzzleDB&);
+    PuzzleDB& operator=(const PuzzleDB&);
+
+public:
+    explicit PuzzleDB(const std::string& path) : data(NULL), length(0) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("cannot open puzzle database " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            close(fd);
+            throw std::runtime_error("not a puzzle database: " + path);
+        }
+        length = st.st_size;
+        void* map = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+            throw std::runtime_error("cannot map puzzle database " + path);
+        data = static_cast<const unsigned char*>(map);
+        header = reinterpret_cast<const Header*>(data);
+        if (std::memcmp(header->magic, "SUDOKUDB", 8) != 0 || header->version != 1 ||
+            header->cells != CELLS || header->table % 8 != 0 || header->table > length ||
+            (length - header->table) / 8 < header->count) {
+            munmap(const_cast<unsigned char*>(data), length);
+            throw std::runtime_error("not a puzzle database: " + path);
+        }
+        offsets = reinterpret_cast<const uint64_t*>(data + header->table);
+    }
+
+    ~PuzzleDB() {
+        munmap(const_cast<unsigned char*>(data), length);
+    }
+
+    uint64_t size() const {
+        return header->count;
+    }
+
+    // The cells of puzzle id, row by row
+    void get(uint64_t id, int* cells) const {
+        if (id >= header->count || offsets[id] > length - RECORD)
+            throw std::out_of_range("no puzzle " + std::to_string(id));
+        const unsigned char* record = data + offsets[id];
+        for (int i = 0; i < CELLS; i++)
+            cells[i] = i % 2 == 0 ? record[i / 2] & 0xf : record[i / 2] >> 4;
+    }
+
+    // Write puzzles, CELLS values each, as a database to path
+    static void write(const std::string& path, const std::vector<int>& puzzles) {
+        uint64_t count = puzzles.size() / CELLS;
+        Header h;
+        std::memcpy(h.magic, "SUDOKUDB", 8);
+        h.version = 1;
+        h.cells = CELLS;
+        h.count = count;
+        h.table = sizeof(Header);
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp.c_str(), std::ios::binary);
+            out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            uint64_t records = h.table + 8 * count;
+            for (uint64_t i = 0; i < count; i++) {
+                uint64_t offset = records + i * RECORD;
+                out.write(reinterpret_cast<const char*>(&offset), 8);
+            }
+            unsigned char record[RECORD];
+            for (uint64_t i = 0; i < count; i++) {
+                std::memset(record, 0, RECORD);
+                for (int c = 0; c < CELLS; c++)
+                    record[c / 2] |= (puzzles[i * CELLS + c] & 0xf) << (c % 2 == 0 ? 0 : 4);
+                out.write(reinterpret_cast<const char*>(record), RECORD);
+            }
+            if (!out)
+                throw std::runtime_error("cannot write " + tmp);
+        }
+        if (rename(tmp.c_str(), path.c_str()) != 0)
+            throw std::runtime_error("cannot write " + path);
+    }
+};
+
+#endif
@@ -0,0 +1,89 @@
+// Recomputation distances calibrated for a model
+//
+// A search engine with commit distance c_d clones the space every c_d
+// levels and recomputes the spaces in between from the last clone. With
+// clone time t_c and time t_p to commit to an alternative and propagate,
+// a node costs about t_c / c_d for cloning and t_p * c_d / 2 for
+// recomputation on average, which is smallest for
+//
+//   c_d = sqrt(2 * t_c / t_p)
+//
+// calibrate() measures t_c and t_p on a few random dives from the root of
+// the model and sets the commit and adaptive distances of the options.
+// The clones of the dives are left out of the clone statistics.
+
+#ifndef RECOMPUTATION_HH
+#define RECOMPUTATION_HH
+
+#include <gecode/kernel.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "clone-stats.hh"
+
+// Largest commit distance chosen by calibration
+const unsigned int MAX_COMMIT_DISTANCE = 64;
+
+template<class Model, class Options>
+void calibrate(Options& opt) {
+    typedef std::chrono::steady_clock clock;
+    std::mt19937 random(1);
+    double cloneTime = 0, propagateTime = 0;
+    unsigned long int clones = 0, commits = 0;
+    bool cloneStats = CloneStats::active();
+    CloneStats::enable(false);
+
+    Model* root = new Model(opt);
+    if (root->status() != Gecode::SS_FAILED) {
+        for (unsigned int dive = 0; dive < opt.calibrate(); dive++) {
+            Gecode::Space* s = root->clone();
+            while (s->status() == Gecode::SS_BRANCH) {
+                const Gecode::Choice* ch = s->choice();
+
+                clock::time_point start = clock::now();
+                Gecode::Space* c = s->clone();
+                cloneTime += std::chrono::duration<double, std::micro>(clock::now() - start).count();
+                clones++;
+                delete c;
+
+                std::uniform_int_distribution<unsigned int> alternative(0, ch->alternatives() - 1);
+                start = clock::now();
+                s->commit(*ch, alternative(random));
+                Gecode::SpaceStatus status = s->status();
+                propagateTime += std::chrono::duration<double, std::micro>(clock::now() - start).count();
+                commits++;
+                delete ch;
+                if (status != Gecode::SS_BRANCH)
+                    break;
+            }
+            delete s;
+        }
+    }
+    delete root;
+    CloneStats::enable(cloneStats);
+
+    if (clones == 0 || commits == 0 || propagateTime <= 0) {
+        std::cout << "calibration: no search below the root, keeping -c-d "
+                  << opt.c_d() << " -a-d " << opt.a_d() << std::endl;
+        return;
+    }
+    double tc = cloneTime / clones;
+    double tp = propagateTime / commits;
+    unsigned int cd = static_cast<unsigned int>(std::lround(std::sqrt(2 * tc / tp)));
+    cd = std::min(std::max(cd, 1u), MAX_COMMIT_DISTANCE);
+    // Clone in the middle of long recomputations, as Gecode's defaults do
+    unsigned int ad = std::max(cd / 4, 1u);
+    opt.c_d(cd);
+    opt.a_d(ad);
+    std::cout << "calibration:" << std::endl
+              << "\tprobe nodes:  " << commits << std::endl
+              << "\tclone:        " << tc << " us" << std::endl
+              << "\tpropagation:  " << tp << " us" << std::endl
+              << "\tchoice:       -c-d " << cd << " -a-d " << ad << std::endl;
+}
+
+#endif
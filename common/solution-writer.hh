@@ -0,0 +1,173 @@
+// Buffered output of solutions for high-volume solving
+//
+// Models hand every solution as a list of values to the writer instead of
+// printing it. The writer formats it either as one compact line, or as a
+// packed binary record, into a large buffer that is written out only when
+// it is full and when the writer is closed, never per solution.
+//
+// Binary file layout, integers in host byte order (little endian on x86):
+//   header   magic "GSOLUTNS", uint32 values per record, uint32 bits per value
+//   records  the values packed at that many bits, lowest bits first, each
+//            record padded to whole bytes
+//
+// The solutions tool decodes a binary file into compact lines.
+
+#ifndef SOLUTION_WRITER_HH
+#define SOLUTION_WRITER_HH
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class SolutionWriter {
+public:
+    enum Format {
+        TEXT,    /// The model's own print, the writer is unused
+        COMPACT, /// One line per solution
+        BINARY   /// Packed binary records
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t values;
+        uint32_t bits;
+    };
+
+protected:
+    // Bytes collected before writing them out
+    static const size_t BUFFER = 1 << 20;
+
+    Format format;
+    int fd;
+    bool ownsFd;
+    std::vector<char> buffer;
+    size_t used;
+    // Values per solution and bits per value, fixed by the first solution
+    uint32_t values, bits;
+    // Largest value of a solution, decides the bits and the separators
+    int maxValue;
+    unsigned long int solutions;
+
+    void flush() {
+        size_t done = 0;
+        while (done < used) {
+            ssize_t w = ::write(fd, &buffer[done], used - done);
+            if (w <= 0)
+                throw std::runtime_error("cannot write solutions");
+            done += w;
+        }
+        used = 0;
+    }
+
+    void append(const char* data, size_t n) {
+        if (used + n > buffer.size())
+            flush();
+        if (n > buffer.size()) {
+            buffer.resize(n);
+        }
+        std::memcpy(&buffer[used], data, n);
+        used += n;
+    }
+
+    SolutionWriter() : format(TEXT), fd(1), ownsFd(false), used(0),
+                       values(0), bits(0), maxValue(0), solutions(0) {}
+
+public:
+    // The writer of the process
+    static SolutionWriter& global() {
+        static SolutionWriter writer;
+        return writer;
+    }
+
+    // Write solutions with values in 0..maxValue to path, stdout if NULL.
+    // Binary records need a file of their own, on stdout they would be
+    // mixed with the statistics the drivers print.
+    void open(int f, const char* path, int maxValue0) {
+        if (f == BINARY && path == NULL)
+            throw std::runtime_error("-output binary needs -output-file");
+        format = static_cast<Format>(f);
+        maxValue = maxValue0;
+        solutions = 0;
+        used = 0;
+        bits = 1;
+        while ((1 << bits) <= maxValue && bits < 31)
+            bits++;
+        if (format == TEXT)
+            return;
+        buffer.resize(BUFFER);
+        if (path != NULL) {
+            fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+                throw std::runtime_error(std::string("cannot open ") + path);
+            ownsFd = true;
+        }
+    }
+
+    // Whether solutions go to the writer instead of the model's print
+    bool active() const {
+        return format != TEXT;
+    }
+
+    unsigned long int count() const {
+        return solutions;
+    }
+
+    void write(const std::vector<int>& v) {
+        if (solutions++ == 0) {
+            values = v.size();
+            if (format == BINARY) {
+                Header h;
+                std::memcpy(h.magic, "GSOLUTNS", 8);
+                h.values = values;
+                h.bits = bits;
+                append(reinterpret_cast<const char*>(&h), sizeof(h));
+            }
+        }
+        if (v.size() != values)
+            throw std::runtime_error("solutions of different sizes");
+        if (format == COMPACT) {
+            char line[16];
+            for (size_t i = 0; i < v.size(); i++) {
+                int n = maxValue < 10 ? std::snprintf(line, sizeof(line), "%d", v[i])
+                                      : std::snprintf(line, sizeof(line), i == 0 ? "%d" : " %d", v[i]);
+                append(line, n);
+            }
+            append("\n", 1);
+        } else {
+            size_t bytes = (static_cast<size_t>(values) * bits + 7) / 8;
+            if (used + bytes > buffer.size())
+                flush();
+            if (bytes > buffer.size())
+                buffer.resize(bytes);
+            unsigned char* record = reinterpret_cast<unsigned char*>(&buffer[used]);
+            std::memset(record, 0, bytes);
+            size_t bit = 0;
+            for (size_t i = 0; i < v.size(); i++) {
+                for (uint32_t b = 0; b < bits; b++, bit++) {
+                    if ((v[i] >> b) & 1)
+                        record[bit / 8] |= 1 << (bit % 8);
+                }
+            }
+            used += bytes;
+        }
+    }
+
+    void close() {
+        if (format == TEXT)
+            return;
+        flush();
+        if (ownsFd)
+            ::close(fd);
+        fd = 1;
+        ownsFd = false;
+        format = TEXT;
+    }
+};
+
+#endif
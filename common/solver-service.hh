@@ -0,0 +1,247 @@
+// A long-lived solver service on a Unix domain socket
+//
+// Every message in either direction is a frame: a 4-byte big-endian
+// length followed by that many bytes of text. A request is a command
+// name, a space and the arguments of the command. The reply starts with
+// "ok", "unsat" or "error" on its own line, followed by the answer.
+//
+// A connection may send any number of requests. Connections are handed to
+// a fixed pool of worker threads, so as many requests as there are
+// workers are answered concurrently. The latency of every request is
+// counted in a histogram with power of two buckets in microseconds, which
+// the built-in "stats" command returns.
+
+#ifndef SOLVER_SERVICE_HH
+#define SOLVER_SERVICE_HH
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Frame {
+
+    // Read exactly n bytes, false on end of file or error
+    inline bool readAll(int fd, char* buffer, size_t n) {
+        while (n > 0) {
+            ssize_t r = ::read(fd, buffer, n);
+            if (r <= 0)
+                return false;
+            buffer += r;
+            n -= r;
+        }
+        return true;
+    }
+
+    // Write exactly n bytes, without SIGPIPE when the peer went away
+    inline bool writeAll(int fd, const char* buffer, size_t n) {
+        while (n > 0) {
+            ssize_t w = ::send(fd, buffer, n, MSG_NOSIGNAL);
+            if (w <= 0)
+                return false;
+            buffer += w;
+            n -= w;
+        }
+        return true;
+    }
+
+    // Largest frame accepted, protects the server from garbage lengths
+    const uint32_t MAX_LENGTH = 1 << 24;
+
+    inline bool read(int fd, std::string& message) {
+        unsigned char header[4];
+        if (!readAll(fd, reinterpret_cast<char*>(header), 4))
+            return false;
+        uint32_t length = (uint32_t(header[0]) << 24) | (uint32_t(header[1]) << 16) |
+                          (uint32_t(header[2]) << 8) | uint32_t(header[3]);
+        if (length > MAX_LENGTH)
+            return false;
+        message.resize(length);
+        return length == 0 || readAll(fd, &message[0], length);
+    }
+
+    inline bool write(int fd, const std::string& message) {
+        uint32_t length = message.size();
+        unsigned char header[4] = {
+                static_cast<unsigned char>(length >> 24), static_cast<unsigned char>(length >> 16),
+                static_cast<unsigned char>(length >> 8), static_cast<unsigned char>(length)
+        };
+        return writeAll(fd, reinterpret_cast<const char*>(header), 4) &&
+               writeAll(fd, message.data(), message.size());
+    }
+
+    // Connect to the service listening on path, -1 on failure
+    inline int connect(const std::string& path) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+}
+
+// Request latencies in buckets [2^k, 2^(k+1)) microseconds
+class LatencyHistogram {
+protected:
+    static const int BUCKETS = 40;
+    std::atomic<unsigned long int> counts[BUCKETS];
+    std::atomic<unsigned long int> total;
+public:
+    LatencyHistogram() : total(0) {
+        for (int i = 0; i < BUCKETS; i++)
+            counts[i] = 0;
+    }
+
+    void add(double us) {
+        int bucket = 0;
+        for (unsigned long int u = static_cast<unsigned long int>(us); u > 1 && bucket < BUCKETS - 1; u >>= 1)
+            bucket++;
+        counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(static_cast<unsigned long int>(us), std::memory_order_relaxed);
+    }
+
+    void print(std::ostream& os) const {
+        unsigned long int n = 0;
+        for (int i = 0; i < BUCKETS; i++)
+            n += counts[i];
+        os << "requests: " << n << ", mean: " << (n > 0 ? total / n : 0) << " us" << std::endl;
+        for (int i = 0; i < BUCKETS; i++) {
+            if (counts[i] > 0)
+                os << "\t< " << (1ul << (i + 1)) << " us: " << counts[i] << std::endl;
+        }
+    }
+};
+
+class SolverService {
+public:
+    // Answers the arguments of a request, starting with "ok", "unsat" or "error"
+    typedef std::function<std::string(const std::string&)> Handler;
+
+protected:
+    std::map<std::string, Handler> handlers;
+    std::map<std::string, LatencyHistogram*> latencies;
+
+    // Accepted connections waiting for a worker
+    std::queue<int> connections;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+
+    std::string answer(const std::string& request) {
+        std::string command = request.substr(0, request.find(' '));
+        std::string arguments = command.size() < request.size() ? request.substr(command.size() + 1) : "";
+        if (command == "stats") {
+            std::ostringstream os;
+            os << "ok" << std::endl;
+            for (std::map<std::string, LatencyHistogram*>::const_iterator i = latencies.begin();
+                 i != latencies.end(); ++i) {
+                os << i->first << " ";
+                i->second->print(os);
+            }
+            return os.str();
+        }
+        std::map<std::string, Handler>::const_iterator h = handlers.find(command);
+        if (h == handlers.end())
+            return "error\nunknown command " + command + "\n";
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::string reply;
+        try {
+            reply = h->second(arguments);
+        } catch (std::exception& e) {
+            reply = std::string("error\n") + e.what() + "\n";
+        }
+        latencies.find(command)->second->add(std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - start).count());
+        return reply;
+    }
+
+    void serve(int fd) {
+        std::string request;
+        while (Frame::read(fd, request)) {
+            if (!Frame::write(fd, answer(request)))
+                break;
+        }
+        close(fd);
+    }
+
+    void work() {
+        for (;;) {
+            int fd;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeUp.wait(lock, [this] { return !connections.empty(); });
+                fd = connections.front();
+                connections.pop();
+            }
+            serve(fd);
+        }
+    }
+
+public:
+    ~SolverService() {
+        for (std::map<std::string, LatencyHistogram*>::iterator i = latencies.begin();
+             i != latencies.end(); ++i)
+            delete i->second;
+    }
+
+    // Register a command, only before run()
+    void add(const std::string& command, Handler handler) {
+        handlers[command] = handler;
+        latencies[command] = new LatencyHistogram();
+    }
+
+    // Listen on path and answer requests with the given number of workers
+    void run(const std::string& path, unsigned int workers) {
+        int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0)
+            throw std::runtime_error("cannot create socket");
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            throw std::runtime_error("socket path too long: " + path);
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        unlink(path.c_str());
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listener, 64) != 0)
+            throw std::runtime_error("cannot listen on " + path);
+
+        std::vector<std::thread> pool;
+        for (unsigned int i = 0; i < std::max(workers, 1u); i++)
+            pool.push_back(std::thread(&SolverService::work, this));
+        for (;;) {
+            int fd = accept(listener, NULL, NULL);
+            if (fd < 0)
+                continue;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                connections.push(fd);
+            }
+            wakeUp.notify_one();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,190 @@
+// Live progress reports for long searches
+//
+// The search engines call Search::Stop::stop() at every node with their
+// current statistics. Progress is such a stop object: it copies the
+// statistics into atomics, checks the usual node, fail and time limits,
+// and never stops the search otherwise. A background thread reads the
+// atomics at a fixed interval and reports nodes per second, failures,
+// depth, propagations and memory to stderr or as JSON lines to a file.
+//
+// The reports follow a single search, so -progress runs with -mode
+// solution, printing the solutions, or stat, printing only the summary.
+// -mode time and gist are rejected.
+//
+// Gecode only hands the maximal depth of the search stack to the stop
+// object, the current depth is not available. With several threads each
+// worker reports its own statistics, so run with one thread for exact
+// numbers.
+
+#ifndef TELEMETRY_HH
+#define TELEMETRY_HH
+
+#include <gecode/search.hh>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "driver-options.hh"
+
+class Progress : public Gecode::Search::Stop {
+protected:
+    typedef std::chrono::steady_clock clock;
+
+    // Interval between reports
+    std::chrono::milliseconds interval;
+    // JSON lines output, stderr if not open
+    std::ofstream json;
+    // Limits from the options, 0 for none
+    unsigned long int nodeLimit, failLimit, timeLimit;
+    clock::time_point start;
+
+    // Latest statistics from the search
+    std::atomic<unsigned long int> nodes, fails, depth, propagations;
+
+    // The reporting thread and how to wake it up for the last report
+    std::thread reporter;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool done;
+
+    // Resident memory of the process in kilobytes
+    static unsigned long int residentKB() {
+        unsigned long int size = 0, resident = 0;
+        if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+            if (std::fscanf(f, "%lu %lu", &size, &resident) != 2)
+                resident = 0;
+            std::fclose(f);
+        }
+        return resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+
+    void report(double ms, double nodesPerSecond) {
+        if (json.is_open()) {
+            json << "{\"ms\":" << ms
+                 << ",\"nodes\":" << nodes
+                 << ",\"nodes_per_second\":" << nodesPerSecond
+                 << ",\"failures\":" << fails
+                 << ",\"max_depth\":" << depth
+                 << ",\"propagations\":" << propagations
+                 << ",\"resident_kb\":" << residentKB() << "}" << std::endl;
+        } else {
+            std::cerr << "[" << ms / 1000 << " s] "
+                      << "nodes: " << nodes << " (" << nodesPerSecond << "/s), "
+                      << "failures: " << fails << ", "
+                      << "max depth: " << depth << ", "
+                      << "propagations: " << propagations << ", "
+                      << "memory: " << residentKB() << " KB" << std::endl;
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        unsigned long int lastNodes = 0;
+        clock::time_point last = start;
+        bool lastReport = false;
+        while (!lastReport) {
+            lastReport = wakeUp.wait_for(lock, interval, [this] { return done; });
+            clock::time_point now = clock::now();
+            double seconds = std::chrono::duration<double>(now - last).count();
+            unsigned long int n = nodes;
+            report(std::chrono::duration<double, std::milli>(now - start).count(),
+                   seconds > 0 ? (n - lastNodes) / seconds : 0);
+            lastNodes = n;
+            last = now;
+        }
+    }
+
+public:
+    Progress(const DriverOptions& opt)
+            : interval(opt.progress()),
+              nodeLimit(opt.node()), failLimit(opt.fail()), timeLimit(opt.time()),
+              start(clock::now()),
+              nodes(0), fails(0), depth(0), propagations(0), done(false) {
+        if (opt.progressFile() != NULL)
+            json.open(opt.progressFile());
+        reporter = std::thread(&Progress::run, this);
+    }
+
+    // Record the statistics and check the limits
+    virtual bool stop(const Gecode::Search::Statistics& s, const Gecode::Search::Options&) {
+        nodes.store(s.node, std::memory_order_relaxed);
+        fails.store(s.fail, std::memory_order_relaxed);
+        depth.store(s.depth, std::memory_order_relaxed);
+        propagations.store(s.propagate, std::memory_order_relaxed);
+        return (nodeLimit > 0 && s.node > nodeLimit) ||
+               (failLimit > 0 && s.fail > failLimit) ||
+               (timeLimit > 0 &&
+                clock::now() - start > std::chrono::milliseconds(timeLimit));
+    }
+
+    // Report the final statistics and stop the reporting thread
+    void finish(const Gecode::Search::Statistics& s) {
+        stop(s, Gecode::Search::Options::def);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        wakeUp.notify_one();
+        reporter.join();
+    }
+
+    ~Progress() {
+        if (reporter.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done = true;
+            }
+            wakeUp.notify_one();
+            reporter.join();
+        }
+    }
+};
+
+// Run a model like Script::run does, while reporting progress
+template<class Model, template<class> class Engine, class Options>
+void runWithProgress(const Options& opt) {
+    if (opt.mode() != Gecode::SM_SOLUTION && opt.mode() != Gecode::SM_STAT)
+        throw std::runtime_error("-progress runs with -mode solution or stat only");
+    Progress progress(opt);
+    Model* root = new Model(opt);
+    Gecode::Search::Options so;
+    so.threads = opt.threads();
+    so.c_d = opt.c_d();
+    so.a_d = opt.a_d();
+    so.stop = &progress;
+    Engine<Model> e(root, so);
+    delete root;
+
+    unsigned int solutions = 0;
+    while (Model* s = e.next()) {
+        if (opt.mode() == Gecode::SM_SOLUTION)
+            s->print(std::cout);
+        delete s;
+        if (++solutions == opt.solutions())
+            break;
+    }
+    Gecode::Search::Statistics stat = e.statistics();
+    progress.finish(stat);
+
+    std::cout << std::endl
+              << "Summary" << std::endl
+              << "\tsolutions:    " << solutions << std::endl
+              << "\tpropagations: " << stat.propagate << std::endl
+              << "\tnodes:        " << stat.node << std::endl
+              << "\tfailures:     " << stat.fail << std::endl
+              << "\trestarts:     " << stat.restart << std::endl
+              << "\tmax depth:    " << stat.depth << std::endl;
+    if (e.stopped())
+        std::cout << "Search engine stopped..." << std::endl;
+}
+
+#endif
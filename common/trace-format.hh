@@ -0,0 +1,48 @@
+// File format of search-tree traces, see trace.hh
+//
+// Integers in host byte order (little endian on x86):
+//   header   magic "GTRACE01", uint32 sampling rate, uint32 reserved
+//   nodes    one Node each, followed by uint16 length and the description
+//            of the choice that led to the node, empty for the root
+//
+// Nodes are written in the order they are explored, so a node always
+// comes after its parent. With a sampling rate k only every k-th node is
+// written, and parent is the closest ancestor that was written.
+
+#ifndef TRACE_FORMAT_HH
+#define TRACE_FORMAT_HH
+
+#include <cstdint>
+
+namespace Trace {
+    const char MAGIC[8] = {'G', 'T', 'R', 'A', 'C', 'E', '0', '1'};
+
+    // Parent of the root
+    const uint64_t NONE = ~static_cast<uint64_t>(0);
+
+    enum Outcome {
+        FAILED = 0, ///< Propagation failed
+        SOLVED = 1, ///< A solution
+        BRANCH = 2  ///< Search continues below the node
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t sample;
+        uint32_t reserved;
+    };
+
+    struct Node {
+        uint64_t id;
+        uint64_t parent;
+        uint32_t depth;
+        // Alternative of the parent's choice that led to the node
+        uint16_t alternative;
+        uint8_t outcome;
+        uint8_t reserved;
+        // Time of the propagation to the fixpoint of the node
+        uint64_t ns;
+    };
+}
+
+#endif
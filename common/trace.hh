@@ -0,0 +1,188 @@
+// Headless search-tree traces
+//
+// runWithTrace() searches a model with its own depth-first search, which
+// explores the same tree as Gecode's DFS but without recomputation, and
+// streams every node to a file: its id, the parent, the depth, the choice
+// that led to it, the time of its propagation and whether it failed, was
+// a solution or branched. See trace-format.hh for the file format, and
+// the tracesum tool for a summary of the costliest subtrees.
+//
+// With -trace-sample k only every k-th node is written, which keeps the
+// file small and leaves only the propagation timing for the other nodes.
+
+#ifndef TRACE_HH
+#define TRACE_HH
+
+#include <gecode/kernel.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "trace-format.hh"
+
+namespace Trace {
+    // Writes the sampled nodes to a trace file
+    class Recorder {
+    protected:
+        std::vector<char> buffer;
+        std::ofstream out;
+        uint32_t sample;
+        unsigned long int written;
+    public:
+        Recorder(const char* path, unsigned int sample0)
+                : buffer(1 << 20), sample(sample0 > 0 ? sample0 : 1), written(0) {
+            // The buffer must be set before the file is opened
+            out.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
+            out.open(path, std::ios::binary);
+            if (!out)
+                throw std::runtime_error(std::string("cannot open ") + path);
+            Header h;
+            std::memcpy(h.magic, MAGIC, sizeof(h.magic));
+            h.sample = sample;
+            h.reserved = 0;
+            out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        }
+
+        bool sampled(uint64_t id) const {
+            return id % sample == 0;
+        }
+
+        unsigned long int nodes() const {
+            return written;
+        }
+
+        void node(const Node& n, const std::string& choice) {
+            uint16_t length = choice.size() < 0xffff ? choice.size() : 0xffff;
+            out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            out.write(choice.data(), length);
+            written++;
+        }
+    };
+}
+
+// Run a model like Script::run does, while tracing the search tree to the
+// file of -trace. Honours the solution, node, fail and time limits.
+template<class Model, class Options>
+void runWithTrace(const Options& opt) {
+    typedef std::chrono::steady_clock clock;
+
+    // A node that branched, with the alternatives still to explore
+    struct Entry {
+        Gecode::Space* space;
+        const Gecode::Choice* choice;
+        unsigned int next;
+        // The node, or its closest ancestor that was written
+        uint64_t recorded;
+        uint32_t depth;
+    };
+
+    Trace::Recorder recorder(opt.trace(), opt.traceSample());
+    std::vector<Entry> stack;
+    unsigned long int nodes = 0, fails = 0, propagations = 0;
+    unsigned int solutions = 0, maxDepth = 0;
+    clock::time_point start = clock::now();
+
+    Gecode::Space* s = new Model(opt);
+    uint64_t parent = Trace::NONE;
+    uint32_t depth = 0;
+    unsigned int alternative = 0;
+    std::string choice;
+    bool stopped = false;
+    while (true) {
+        // Propagate the node s and record it
+        uint64_t id = nodes++;
+        Gecode::StatusStatistics stat;
+        clock::time_point before = clock::now();
+        Gecode::SpaceStatus status = s->status(stat);
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - before).count();
+        propagations += stat.propagate;
+        maxDepth = std::max(maxDepth, depth);
+        if (recorder.sampled(id)) {
+            Trace::Node n;
+            n.id = id;
+            n.parent = parent;
+            n.depth = depth;
+            n.alternative = alternative;
+            n.outcome = status == Gecode::SS_FAILED ? Trace::FAILED :
+                        status == Gecode::SS_SOLVED ? Trace::SOLVED : Trace::BRANCH;
+            n.reserved = 0;
+            n.ns = ns;
+            recorder.node(n, choice);
+        }
+        if (status == Gecode::SS_FAILED) {
+            fails++;
+            delete s;
+        } else if (status == Gecode::SS_SOLVED) {
+            static_cast<Model*>(s)->print(std::cout);
+            delete s;
+            if (++solutions == opt.solutions())
+                break;
+        } else {
+            Entry e;
+            e.space = s;
+            e.choice = s->choice();
+            e.next = 0;
+            e.recorded = recorder.sampled(id) ? id : parent;
+            e.depth = depth;
+            stack.push_back(e);
+        }
+
+        if ((opt.node() > 0 && nodes >= opt.node()) || (opt.fail() > 0 && fails >= opt.fail()) ||
+            (opt.time() > 0 && clock::now() - start > std::chrono::milliseconds(opt.time()))) {
+            stopped = !stack.empty();
+            break;
+        }
+        if (stack.empty())
+            break;
+
+        // Next alternative of the deepest node that branched, the last
+        // alternative takes the space of that node over
+        Entry& e = stack.back();
+        alternative = e.next++;
+        parent = e.recorded;
+        depth = e.depth + 1;
+        choice.clear();
+        if (recorder.sampled(nodes)) {
+            std::ostringstream os;
+            e.space->print(*e.choice, alternative, os);
+            choice = os.str();
+        }
+        const Gecode::Choice* c = e.choice;
+        if (alternative + 1 == c->alternatives()) {
+            s = e.space;
+            stack.pop_back();
+            s->commit(*c, alternative);
+            delete c;
+        } else {
+            s = e.space->clone();
+            s->commit(*c, alternative);
+        }
+    }
+    for (size_t i = 0; i < stack.size(); i++) {
+        delete stack[i].choice;
+        delete stack[i].space;
+    }
+
+    std::cout << std::endl
+              << "Summary" << std::endl
+              << "\truntime:      " << std::chrono::duration<double, std::milli>(clock::now() - start).count()
+              << " ms" << std::endl
+              << "\tsolutions:    " << solutions << std::endl
+              << "\tpropagations: " << propagations << std::endl
+              << "\tnodes:        " << nodes << std::endl
+              << "\tfailures:     " << fails << std::endl
+              << "\tmax depth:    " << maxDepth << std::endl
+              << "\ttraced nodes: " << recorder.nodes() << std::endl;
+    if (stopped)
+        std::cout << "Search engine stopped..." << std::endl;
+}
+
+#endif